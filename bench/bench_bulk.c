@@ -0,0 +1,103 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <ihex.h>
+
+#include "workload.h"
+
+#define RECORD_SIZE 16
+
+static const struct workload bulk_workloads[] = {
+	{ "dense", WORKLOAD_ASCENDING, RECORD_SIZE, RECORD_SIZE, 1, 0 },
+	{ "shuffled", WORKLOAD_SHUFFLED, RECORD_SIZE, RECORD_SIZE, 1, 0 },
+	/* records separated by gaps in random order */
+	{ "sparse", WORKLOAD_SHUFFLED, RECORD_SIZE, 4 * RECORD_SIZE, 1, 0 },
+};
+
+static double parse_hex(const char *hex, size_t length, int bulk_load)
+{
+	struct ihex_object *ihex;
+	double start;
+	double elapsed;
+
+	ihex = ihex_new();
+	if (ihex == NULL)
+		return -1;
+	ihex_set_bulk_load(ihex, bulk_load);
+
+	start = workload_now();
+	if (ihex_parse_buffer(ihex, hex, length) != 0) {
+		fprintf(stderr, "parse error: %s\n", ihex_get_error_string(ihex));
+		ihex_delete(ihex);
+		return -1;
+	}
+	elapsed = workload_now() - start;
+
+	ihex_delete(ihex);
+
+	return elapsed;
+}
+
+int main(int argc, char **argv)
+{
+	const struct workload *workload;
+	unsigned int i;
+	uint32_t records;
+	uint32_t size_mb;
+	char *hex;
+	size_t length;
+	double incremental;
+	double bulk;
+
+	size_mb = (argc > 1) ? atoi(argv[1]) : 4;
+	records = size_mb * 1024 * 1024 / RECORD_SIZE;
+
+	printf("# %u records of %u bytes\n", records, RECORD_SIZE);
+	printf("workload,mode,seconds,text_mb_per_s,records_per_s,speedup\n");
+
+	for (i = 0; i < sizeof(bulk_workloads) / sizeof(bulk_workloads[0]); i++) {
+		workload = &bulk_workloads[i];
+		hex = workload_create(workload, records, &length);
+		if (hex == NULL) {
+			fprintf(stderr, "cannot create test input\n");
+			return 1;
+		}
+
+		incremental = parse_hex(hex, length, 0);
+		bulk = parse_hex(hex, length, 1);
+		if ((incremental < 0) || (bulk < 0))
+			return 1;
+
+		printf("%s,incremental,%.4f,%.1f,%.0f,%.2f\n", workload->name, incremental, length / incremental / 1e6,
+		       records / incremental, 1.0);
+		printf("%s,bulk,%.4f,%.1f,%.0f,%.2f\n", workload->name, bulk, length / bulk / 1e6, records / bulk, incremental / bulk);
+
+		free(hex);
+	}
+
+	return 0;
+}
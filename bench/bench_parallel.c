@@ -0,0 +1,143 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <ihex.h>
+
+#define IMAGE_ADDRESS 0x08000000
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static char *create_hex(uint32_t size, size_t *length)
+{
+	struct ihex_object *ihex;
+	uint8_t *data;
+	char *hex;
+	FILE *fp;
+	uint32_t i;
+
+	data = malloc(size);
+	if (data == NULL)
+		return NULL;
+	for (i = 0; i < size; i++)
+		data[i] = (uint8_t)(i * 13 + (i >> 9));
+
+	ihex = ihex_new();
+	if ((ihex == NULL) || (ihex_set_data(ihex, IMAGE_ADDRESS, data, size) != 0))
+		return NULL;
+
+	fp = open_memstream(&hex, length);
+	if ((fp == NULL) || (ihex_dump_file(ihex, fp) != 0))
+		return NULL;
+	fclose(fp);
+
+	ihex_delete(ihex);
+	free(data);
+
+	return hex;
+}
+
+int main(int argc, char **argv)
+{
+	struct ihex_object *ihex;
+	FILE *out;
+	char *hex;
+	size_t length;
+	uint32_t size_mb;
+	unsigned int threads;
+	unsigned int max_threads;
+	double start;
+	double elapsed;
+	double serial;
+
+	size_mb = (argc > 1) ? atoi(argv[1]) : 64;
+	max_threads = (argc > 2) ? atoi(argv[2]) : 2 * sysconf(_SC_NPROCESSORS_ONLN);
+
+	hex = create_hex(size_mb * 1024 * 1024, &length);
+	if (hex == NULL) {
+		fprintf(stderr, "cannot create test image\n");
+		return 1;
+	}
+
+	printf("# image %u MiB, text %zu bytes, %ld cpus online\n", size_mb, length, sysconf(_SC_NPROCESSORS_ONLN));
+	printf("operation,threads,seconds,text_mb_per_s,speedup\n");
+
+	serial = 0;
+	for (threads = 1; threads <= max_threads; threads *= 2) {
+		ihex = ihex_new();
+		if (ihex == NULL)
+			return 1;
+
+		start = now();
+		if (ihex_parse_buffer_parallel(ihex, hex, length, threads) != 0) {
+			fprintf(stderr, "parse error: %s\n", ihex_get_error_string(ihex));
+			return 1;
+		}
+		elapsed = now() - start;
+		if (threads == 1)
+			serial = elapsed;
+
+		printf("parse,%u,%.4f,%.1f,%.2f\n", threads, elapsed, length / elapsed / 1e6, serial / elapsed);
+
+		ihex_delete(ihex);
+	}
+
+	ihex = ihex_new();
+	out = fopen("/dev/null", "w");
+	if ((ihex == NULL) || (out == NULL) || (ihex_parse_buffer(ihex, hex, length) != 0))
+		return 1;
+
+	for (threads = 1; threads <= max_threads; threads *= 2) {
+		start = now();
+		if (ihex_dump_file_parallel(ihex, out, threads) != 0) {
+			fprintf(stderr, "dump error: %s\n", ihex_get_error_string(ihex));
+			return 1;
+		}
+		elapsed = now() - start;
+		if (threads == 1)
+			serial = elapsed;
+
+		printf("dump,%u,%.4f,%.1f,%.2f\n", threads, elapsed, length / elapsed / 1e6, serial / elapsed);
+	}
+
+	fclose(out);
+	ihex_delete(ihex);
+
+	free(hex);
+
+	return 0;
+}
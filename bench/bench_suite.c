@@ -0,0 +1,225 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ihex.h>
+
+#include "workload.h"
+
+#define READ_BLOCK_SIZE 4096
+
+struct result {
+	size_t bytes; /* text or binary bytes processed */
+	uint32_t records; /* data records processed */
+	double seconds; /* best time of all repetitions */
+};
+
+static void print_result(const char *workload, const char *operation, const struct result *result)
+{
+	printf("%s,%s,%zu,%u,%.6f,%.1f,%.0f\n", workload, operation, result->bytes, result->records, result->seconds,
+	       result->bytes / result->seconds / 1e6, result->records / result->seconds);
+}
+
+static void update_time(struct result *result, double seconds)
+{
+	if ((result->seconds == 0) || (seconds < result->seconds))
+		result->seconds = seconds;
+}
+
+static uint32_t count_data_records(const char *hex, size_t length)
+{
+	uint32_t count;
+	size_t i;
+
+	count = 0;
+	for (i = 0; i + 9 <= length; i++) {
+		if ((hex[i] == ':') && (hex[i + 7] == '0') && (hex[i + 8] == '0'))
+			count++;
+	}
+
+	return count;
+}
+
+static int bench_parse(const char *hex, size_t length, uint32_t records, unsigned int reps, struct result *result)
+{
+	struct ihex_object *ihex;
+	double start;
+	unsigned int i;
+
+	result->bytes = length;
+	result->records = records;
+	result->seconds = 0;
+
+	for (i = 0; i < reps; i++) {
+		ihex = ihex_new();
+		if (ihex == NULL)
+			return -1;
+
+		start = workload_now();
+		if (ihex_parse_buffer(ihex, hex, length) != 0) {
+			fprintf(stderr, "parse error: %s\n", ihex_get_error_string(ihex));
+			ihex_delete(ihex);
+			return -1;
+		}
+		update_time(result, workload_now() - start);
+
+		ihex_delete(ihex);
+	}
+
+	return 0;
+}
+
+static int bench_dump(struct ihex_object *ihex, unsigned int reps, struct result *result)
+{
+	char *buf;
+	size_t size;
+	double start;
+	unsigned int i;
+
+	size = ihex_dump_size(ihex);
+	buf = malloc(size);
+	if (buf == NULL)
+		return -1;
+
+	result->bytes = size;
+	result->seconds = 0;
+
+	for (i = 0; i < reps; i++) {
+		start = workload_now();
+		if (ihex_dump_buffer(ihex, buf, size) != 0) {
+			fprintf(stderr, "dump error: %s\n", ihex_get_error_string(ihex));
+			free(buf);
+			return -1;
+		}
+		update_time(result, workload_now() - start);
+	}
+
+	result->records = count_data_records(buf, size);
+	free(buf);
+
+	return 0;
+}
+
+static int bench_get_data(struct ihex_object *ihex, const struct ihex_frozen *frozen, uint32_t records, unsigned int reps, struct result *result)
+{
+	struct ihex_data_segment *last;
+	uint8_t buf[READ_BLOCK_SIZE];
+	uint32_t adr_start;
+	uint32_t adr_end;
+	uint32_t adr;
+	uint32_t size;
+	double start;
+	unsigned int i;
+	int s;
+
+	/* whole image is read in flash page sized blocks, including gaps */
+	last = ihex->segments;
+	while (last->next != NULL)
+		last = last->next;
+	adr_start = ihex->segments->adr_start;
+	adr_end = last->adr_start + last->data_size;
+
+	result->bytes = adr_end - adr_start;
+	result->records = records;
+	result->seconds = 0;
+
+	for (i = 0; i < reps; i++) {
+		start = workload_now();
+		for (adr = adr_start; adr < adr_end; adr += size) {
+			size = (adr_end - adr < READ_BLOCK_SIZE) ? adr_end - adr : READ_BLOCK_SIZE;
+			/* frozen image is read instead of object if given */
+			s = (frozen != NULL) ? ihex_frozen_get_data(frozen, adr, buf, size) : ihex_get_data(ihex, adr, buf, size);
+			if (s != 0) {
+				fprintf(stderr, "get data error: %s\n", ihex_get_error_string(ihex));
+				return -1;
+			}
+		}
+		update_time(result, workload_now() - start);
+	}
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	const struct workload *workload;
+	struct ihex_object *ihex;
+	struct ihex_frozen *frozen;
+	struct result result;
+	uint32_t size_mb;
+	uint32_t records;
+	unsigned int reps;
+	unsigned int i;
+	size_t length;
+	char *hex;
+
+	size_mb = (argc > 1) ? atoi(argv[1]) : 4;
+	reps = (argc > 2) ? atoi(argv[2]) : 3;
+
+	printf("# %u MiB of data per workload, best of %u runs\n", size_mb, reps);
+	printf("workload,operation,bytes,records,seconds,mb_per_s,records_per_s\n");
+
+	for (i = 0; i < workload_count; i++) {
+		workload = &workloads[i];
+		if ((argc > 3) && (strcmp(argv[3], workload->name) != 0))
+			continue;
+
+		records = size_mb * 1024 * 1024 / workload->record_size;
+		hex = workload_create(workload, records, &length);
+		if (hex == NULL) {
+			fprintf(stderr, "cannot create test input\n");
+			return 1;
+		}
+
+		if (bench_parse(hex, length, records, reps, &result) != 0)
+			return 1;
+		print_result(workload->name, "parse", &result);
+
+		ihex = ihex_new();
+		if ((ihex == NULL) || (ihex_parse_buffer(ihex, hex, length) != 0))
+			return 1;
+
+		if (bench_dump(ihex, reps, &result) != 0)
+			return 1;
+		print_result(workload->name, "dump", &result);
+
+		if (bench_get_data(ihex, NULL, records, reps, &result) != 0)
+			return 1;
+		print_result(workload->name, "get_data", &result);
+
+		frozen = ihex_freeze(ihex);
+		if ((frozen == NULL) || (bench_get_data(ihex, frozen, records, reps, &result) != 0))
+			return 1;
+		print_result(workload->name, "frozen_get_data", &result);
+
+		ihex_frozen_delete(frozen);
+		ihex_delete(ihex);
+		free(hex);
+	}
+
+	return 0;
+}
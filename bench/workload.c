@@ -0,0 +1,151 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "workload.h"
+
+#define REGION_DISTANCE 0x01000000
+
+const struct workload workloads[] = {
+	{ "dense", WORKLOAD_ASCENDING, 16, 16, 1, 0 },
+	{ "descending", WORKLOAD_DESCENDING, 16, 16, 1, 0 },
+	{ "shuffled", WORKLOAD_SHUFFLED, 16, 16, 1, 0 },
+	{ "sparse", WORKLOAD_ASCENDING, 16, 256, 1, 0 },
+	{ "jumps", WORKLOAD_ASCENDING, 16, 16, 2, 0 },
+	{ "crlf", WORKLOAD_ASCENDING, 16, 16, 1, 1 },
+	{ "record32", WORKLOAD_ASCENDING, 32, 32, 1, 0 },
+	{ "record255", WORKLOAD_ASCENDING, 255, 255, 1, 0 },
+};
+
+const unsigned int workload_count = sizeof(workloads) / sizeof(workloads[0]);
+
+double workload_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static char *dump_record(char *out, uint16_t adr, uint8_t type, const uint8_t *data, uint8_t size, int crlf)
+{
+	static const char digits[] = "0123456789ABCDEF";
+	uint8_t sum;
+	int i;
+
+	sum = size + (adr >> 8) + (adr & 0xFF) + type;
+	out += sprintf(out, ":%02X%04X%02X", size, adr, type);
+	for (i = 0; i < size; i++) {
+		*out++ = digits[data[i] >> 4];
+		*out++ = digits[data[i] & 0x0F];
+		sum += data[i];
+	}
+	out += sprintf(out, crlf ? "%02X\r\n" : "%02X\n", (uint8_t)(0x100 - sum));
+
+	return out;
+}
+
+static uint32_t *create_order(enum workload_order order, uint32_t records)
+{
+	uint32_t *result;
+	uint32_t tmp;
+	uint32_t i;
+	uint32_t j;
+
+	result = malloc((size_t)records * sizeof(uint32_t));
+	if (result == NULL)
+		return NULL;
+
+	for (i = 0; i < records; i++)
+		result[i] = (order == WORKLOAD_DESCENDING) ? records - 1 - i : i;
+
+	if (order == WORKLOAD_SHUFFLED) {
+		srand(1);
+		for (i = records - 1; i > 0; i--) {
+			j = ((uint32_t)rand() * (RAND_MAX + 1u) + rand()) % (i + 1);
+			tmp = result[i];
+			result[i] = result[j];
+			result[j] = tmp;
+		}
+	}
+
+	return result;
+}
+
+char *workload_create(const struct workload *workload, uint32_t records, size_t *length)
+{
+	uint32_t *order;
+	uint8_t data[255];
+	uint8_t upper[2];
+	uint32_t old_upper;
+	uint32_t adr;
+	uint32_t i;
+	uint32_t j;
+	uint32_t size;
+	char *hex;
+	char *out;
+
+	order = create_order(workload->order, records);
+	/* every data record may be split and preceded by extended linear address records */
+	hex = malloc((size_t)records * (2 * workload->record_size + 64) + 64);
+	if ((order == NULL) || (hex == NULL)) {
+		free(order);
+		free(hex);
+		return NULL;
+	}
+
+	out = hex;
+	old_upper = 0xFFFFFFFF;
+	for (i = 0; i < records; i++) {
+		adr = WORKLOAD_ADDRESS + (order[i] % workload->regions) * REGION_DISTANCE +
+		      (order[i] / workload->regions) * workload->stride;
+		for (j = 0; j < workload->record_size; j++)
+			data[j] = (uint8_t)(order[i] * 7 + j);
+
+		/* records crossing 64 KiB boundary are split in two */
+		for (j = 0; j < workload->record_size; j += size) {
+			size = workload->record_size - j;
+			if (size > 0x10000 - ((adr + j) & 0xFFFF))
+				size = 0x10000 - ((adr + j) & 0xFFFF);
+			if (((adr + j) & 0xFFFF0000) != old_upper) {
+				upper[0] = (adr + j) >> 24;
+				upper[1] = (adr + j) >> 16;
+				out = dump_record(out, 0, 0x04, upper, 2, workload->crlf);
+				old_upper = (adr + j) & 0xFFFF0000;
+			}
+			out = dump_record(out, (adr + j) & 0xFFFF, 0x00, &data[j], size, workload->crlf);
+		}
+	}
+	out = dump_record(out, 0, 0x01, NULL, 0, workload->crlf);
+
+	free(order);
+
+	*length = out - hex;
+	return hex;
+}
@@ -0,0 +1,72 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef WORKLOAD_H_
+#define WORKLOAD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define WORKLOAD_ADDRESS 0x08000000
+
+enum workload_order {
+	WORKLOAD_ASCENDING,
+	WORKLOAD_DESCENDING,
+	WORKLOAD_SHUFFLED,
+};
+
+struct workload {
+	const char *name;
+	enum workload_order order;
+	uint32_t record_size; /* data bytes in every record */
+	uint32_t stride; /* address distance between consecutive records of one region */
+	uint32_t regions; /* records are distributed round robin between regions 16 MiB apart */
+	int crlf; /* terminate lines with CRLF instead of LF */
+};
+
+/** Representative workloads used by benchmarks */
+extern const struct workload workloads[];
+
+/** Number of entries in workloads table */
+extern const unsigned int workload_count;
+
+/**
+ * Generate intelhex text for given workload.
+ *
+ * @param workload workload description
+ * @param records number of data records
+ * @param length length of generated text (out)
+ *
+ * @return malloc'ed text buffer or NULL on allocation failure
+ */
+char *workload_create(const struct workload *workload, uint32_t records, size_t *length);
+
+/**
+ * Get current time from monotonic clock.
+ *
+ * @return time in seconds
+ */
+double workload_now(void);
+
+#endif /* WORKLOAD_H_ */
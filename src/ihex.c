@@ -22,642 +22,3595 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L /* getline, clock_gettime, posix_madvise in strict ISO C builds */
+#endif
+
 #include "ihex.h"
+#include "ihex_hex.h"
 
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
 
-struct ihex_object *ihex_new(void)
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(IHEX_STATIC_POOL)
+#define IHEX_USE_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef IHEX_USE_THREADS
+#include <pthread.h>
+#include <unistd.h>
+
+#define IHEX_PARALLEL_CHUNK_MIN (256 * 1024) /* smallest text chunk worth a worker thread */
+#define IHEX_PARALLEL_DUMP_MIN (128 * 1024) /* smallest amount of data worth a dump worker thread */
+#endif
+
+#define IHEX_ARENA_ALIGN 8 /* alignment of arena allocations */
+
+#ifdef IHEX_STATS
+#include <time.h>
+
+#define IHEX_STATS_ADD(self, field, value) ((self)->stats.field += (value))
+#define IHEX_STATS_PARSE_END(self) ((self)->stats.parse_ns += ihex_stats_clock() - (self)->stats_parse_start)
+#else
+#define IHEX_STATS_ADD(self, field, value) ((void)0)
+#define IHEX_STATS_PARSE_END(self) ((void)0)
+#endif
+
+#ifndef IHEX_DUMP_BUFFER_SIZE
+#define IHEX_DUMP_BUFFER_SIZE 16384 /* size of on-stack buffer collecting dumped records before write */
+#endif
+
+/**
+ * Output buffer used by dumping methods.
+ */
+struct ihex_writer {
+	char *buf; /* pointer to output buffer, NULL if output is only counted */
+	size_t size; /* output buffer size */
+	size_t pos; /* number of characters in output buffer (or counted) */
+	FILE *fp; /* stream where full buffer is flushed, NULL if output goes only to buffer */
+};
+
+/**
+ * Single record produced by dump cursor.
+ */
+struct ihex_record {
+	uint16_t adr; /* record address field */
+	uint8_t type; /* record type */
+	uint8_t size; /* record data size */
+	const uint8_t *data; /* pointer to record data */
+	uint8_t adr_data[2]; /* data of extended address record */
+	uint8_t run_data[UINT8_MAX]; /* data of record assembled from segment and elided pad byte run */
+};
+
+/**
+ * Position in sequence of records produced by dumping methods.
+ */
+struct ihex_cursor {
+	struct ihex_object *object; /* pointer to dumped object */
+	struct ihex_data_segment *seg; /* currently dumped segment, NULL when all data records are produced */
+	uint32_t offset; /* offset of next record data in current segment */
+	uint32_t span; /* position of currently dumped elided pad byte run */
+	uint32_t span_count; /* number of dumped elided pad byte runs, 0 if they are omitted */
+	uint32_t span_offset; /* offset of next record data in current elided run */
+	uint32_t old_address; /* address of last produced record */
+	int finished_flag; /* flag used to indicate EOF record produced */
+};
+
+/**
+ * Arena memory block, allocations are taken from its end.
+ */
+struct ihex_arena_block {
+	struct ihex_arena_block *next; /* pointer to next arena block */
+	uint8_t *data; /* pointer to block memory */
+	size_t size; /* size of block memory */
+	size_t used; /* number of already allocated bytes */
+};
+
+/**
+ * Data record collected in bulk load mode.
+ */
+struct ihex_log_entry {
+	uint32_t adr; /* absolute address of record data */
+	uint32_t size; /* size of record data */
+	size_t offset; /* offset of record data in log data buffer */
+};
+
+/**
+ * Pull encoder state.
+ */
+struct ihex_encoder {
+	struct ihex_cursor cursor; /* position of next record to encode */
+	char record[IHEX_LINE_SIZE]; /* encoded record partially read */
+	uint32_t record_length; /* length of encoded record */
+	uint32_t record_pos; /* number of already read characters of encoded record */
+};
+
+static void ihex_init(struct ihex_object *self)
 {
-	struct ihex_object *self;
-
-	self = (struct ihex_object *)malloc(sizeof(struct ihex_object));
-	if (self == NULL)
-		return NULL;
+	assert(self != NULL);
 
 	self->segments = NULL;
+	self->index_root = NULL;
+	self->index_count = 0;
+	self->index_hint = NULL;
+	self->arena = NULL;
+	self->arena_current = NULL;
+	self->arena_block_size = 0;
+	self->free_segments = NULL;
+	self->segment_pool = NULL;
+	self->segment_pool_count = 0;
+	self->bulk_load = 0;
+	self->log = NULL;
+	self->log_count = 0;
+	self->log_capacity = 0;
+	self->log_data = NULL;
+	self->log_data_size = 0;
+	self->log_data_capacity = 0;
 	self->pad_byte = 0xFF;
+	self->pad_elision = 0;
+	self->pad_omission = 0;
+	self->pad_spans = NULL;
+	self->pad_span_count = 0;
+	self->pad_span_capacity = 0;
+	self->pad_run_adr = 0;
+	self->pad_run_size = 0;
 	self->align_record = 16;
 	self->extended_address = 0;
 	self->finished_flag = 0;
+	self->data_callback = NULL;
+	self->data_callback_ctx = NULL;
+	self->line_length = 0;
 	self->error = IHEX_NO_ERROR;
-
-	return self;
+#ifdef IHEX_STATS
+	memset(&self->stats, 0, sizeof(self->stats));
+	self->stats_parse_start = 0;
+#endif
 }
 
-void ihex_delete(struct ihex_object *self)
+#ifndef IHEX_STATIC_POOL
+struct ihex_object *ihex_new(void)
 {
-	struct ihex_data_segment *seg;
-	struct ihex_data_segment *seg_next;
+	struct ihex_object *self;
 
-	seg = self->segments;
-	while (seg != NULL) {
-		free(seg->data);
-		seg_next = seg->next;
-		free(seg);
-		seg = seg_next;
-	}
+	self = (struct ihex_object *)malloc(sizeof(struct ihex_object));
+	if (self == NULL)
+		return NULL;
 
-	free(self);
+	ihex_init(self);
+
+	return self;
 }
 
-const char *ihex_get_error_string(struct ihex_object *self)
+struct ihex_object *ihex_new_arena(size_t block_size)
 {
-	switch (self->error) {
-	case IHEX_NO_ERROR:
+	struct ihex_object *self;
+
+	self = ihex_new();
+	if (self == NULL)
 		return NULL;
-	case IHEX_ERROR_DATA_OVERLAPPING:
-		return "Data segments overlapping";
-	case IHEX_ERROR_NO_EOF_LINE:
-		return "No EOF line";
-	case IHEX_ERROR_PARSING_START_LINE:
-		return "Wrong start line char";
-	case IHEX_ERROR_PARSING_HEX_ENCODE:
-		return "Wrong ascii hex encoding";
-	case IHEX_ERROR_PARSING_END_LINE:
-		return "Wrong EOL char";
-	case IHEX_ERROR_ADDRESS_FIELD:
-		return "Incorrect address field";
-	case IHEX_ERROR_LINE_LENGTH:
-		return "Line length error";
-	case IHEX_ERROR_CHECKSUM:
-		return "Checksum error";
-	case IHEX_ERROR_RECORD_TYPE:
-		return "Unsupported record type";
-	case IHEX_ERROR_MALLOC:
-		return "Memory allocation error";
-	case IHEX_ERROR_DUMP:
-		return "Write dump stream error";
-	default:
-		return "Unknown error";
-	}
-	return NULL;
-}
 
-static int ihex_check_data_overlapping(struct ihex_object *self, uint32_t adr, uint32_t size)
-{
-	uint32_t seg_start_adr;
-	uint32_t seg_finish_adr;
+	self->arena_block_size = (block_size != 0) ? block_size : 1;
 
-	uint32_t data_start_adr;
-	uint32_t data_finish_adr;
+	return self;
+}
+#endif
 
-	struct ihex_data_segment *seg;
+static void ihex_pool_release_segments(struct ihex_object *self)
+{
+	uint32_t i;
 
 	assert(self != NULL);
 
-	if (size == 0)
-		return 0;
+	self->free_segments = NULL;
+	for (i = self->segment_pool_count; i > 0; i--) {
+		self->segment_pool[i - 1].next = self->free_segments;
+		self->free_segments = &self->segment_pool[i - 1];
+	}
+}
 
-	seg = self->segments;
-	while (seg != NULL) {
-		seg_start_adr = seg->adr_start;
-		seg_finish_adr = seg->adr_start + seg->data_size - 1;
+int ihex_init_static(struct ihex_object *self, struct ihex_data_segment *segments, uint32_t segment_count, uint8_t *data, size_t data_size)
+{
+	struct ihex_arena_block *block;
+	size_t skip;
 
-		data_start_adr = adr;
-		data_finish_adr = adr + size - 1;
+	assert(self != NULL);
+	assert((segments != NULL) || (segment_count == 0));
+	assert(data != NULL);
 
-		if ((data_start_adr >= seg_start_adr) && (data_start_adr <= seg_finish_adr)) {
-			self->error = IHEX_ERROR_DATA_OVERLAPPING;
-			return -1;
-		}
-		if ((data_finish_adr >= seg_start_adr) && (data_finish_adr <= seg_finish_adr)) {
-			self->error = IHEX_ERROR_DATA_OVERLAPPING;
-			return -1;
-		}
-		if ((data_start_adr <= seg_start_adr) && (data_finish_adr >= seg_finish_adr)) {
-			self->error = IHEX_ERROR_DATA_OVERLAPPING;
-			return -1;
-		}
+	ihex_init(self);
 
-		seg = seg->next;
+	self->segment_pool = segments;
+	self->segment_pool_count = segment_count;
+	ihex_pool_release_segments(self);
+
+	/* the only arena block is placed at the start of data buffer */
+	skip = (IHEX_ARENA_ALIGN - (uintptr_t)data % IHEX_ARENA_ALIGN) % IHEX_ARENA_ALIGN;
+	if (data_size <= skip + sizeof(struct ihex_arena_block)) {
+		/* object stays in pool mode without data memory, so every data allocation fails */
+		self->arena_block_size = SIZE_MAX;
+		self->error = IHEX_ERROR_POOL;
+		return -1;
 	}
+	block = (struct ihex_arena_block *)&data[skip];
+	block->next = NULL;
+	block->data = (uint8_t *)&block[1];
+	block->size = data_size - skip - sizeof(struct ihex_arena_block);
+	block->used = 0;
+
+	self->arena = block;
+	self->arena_current = block;
+	self->arena_block_size = block->size;
 
 	return 0;
 }
 
-static int ihex_new_segment(struct ihex_object *self, uint32_t adr, uint8_t *data, uint32_t size)
+static void ihex_set_alloc_error(struct ihex_object *self)
 {
-	uint8_t *seg_data;
-	struct ihex_data_segment *seg;
-	struct ihex_data_segment *seg_new;
-
 	assert(self != NULL);
-	assert(data != NULL);
-
-	if (size == 0)
-		return 0;
 
-	seg_new = (struct ihex_data_segment *)malloc(sizeof(ihex_data_segment));
-	if (seg_new == NULL) {
-		self->error = IHEX_ERROR_MALLOC;
-		return -1;
-	}
-	seg_new->data = (uint8_t *)malloc(size);
-	if (seg_new->data == NULL) {
-		self->error = IHEX_ERROR_MALLOC;
-		return -1;
-	}
-	seg_new->adr_start = adr;
-	seg_new->data_size = size;
+	self->error = (self->segment_pool != NULL) ? IHEX_ERROR_POOL : IHEX_ERROR_MALLOC;
+}
 
-	memcpy(seg_new->data, data, size);
+static void *ihex_arena_alloc(struct ihex_object *self, size_t size)
+{
+	struct ihex_arena_block *block;
+	size_t start;
 
-	if (self->segments == NULL) {
-		self->segments = seg_new;
-		seg_new->next = NULL;
-		seg_new->prev = NULL;
-		return 0;
+	assert(self != NULL);
+	assert(self->arena_block_size != 0);
+
+	/* blocks after current one are empty, they were kept by ihex_reset */
+	block = self->arena_current;
+	while (block != NULL) {
+		start = (block->used + IHEX_ARENA_ALIGN - 1) & ~(size_t)(IHEX_ARENA_ALIGN - 1);
+		if ((start <= block->size) && (size <= block->size - start)) {
+			block->used = start + size;
+			self->arena_current = block;
+			return &block->data[start];
+		}
+		block = block->next;
 	}
 
-	seg = self->segments;
-	while (1) {
-		if (seg_new->adr_start < seg->adr_start) {
-			seg_new->prev = seg->prev;
-			seg_new->next = seg;
-			seg->prev = seg_new;
-			if (seg_new->prev == NULL)
-				self->segments = seg_new;
-			break;
-		}
+#ifdef IHEX_STATIC_POOL
+	return NULL;
+#else
+	/* static pool never grows */
+	if (self->segment_pool != NULL)
+		return NULL;
 
-		if (seg->next == NULL) {
-			seg->next = seg_new;
-			seg_new->next = NULL;
-			seg_new->prev = seg;
-			break;
-		}
+	block = (struct ihex_arena_block *)malloc(sizeof(struct ihex_arena_block));
+	if (block == NULL)
+		return NULL;
+	block->size = (size > self->arena_block_size) ? size : self->arena_block_size;
+	block->data = (uint8_t *)malloc(block->size);
+	if (block->data == NULL) {
+		free(block);
+		return NULL;
+	}
+	block->used = size;
 
-		seg = seg->next;
+	/* new block is appended at list end */
+	block->next = NULL;
+	if (self->arena_current == NULL) {
+		self->arena = block;
+	} else {
+		while (self->arena_current->next != NULL)
+			self->arena_current = self->arena_current->next;
+		self->arena_current->next = block;
 	}
+	self->arena_current = block;
 
-	return 0;
+	return block->data;
+#endif
 }
 
-static int ihex_join_left(struct ihex_object *self, struct ihex_data_segment *seg_before, uint8_t *data, uint32_t size)
+static int ihex_arena_resize(struct ihex_object *self, void *ptr, size_t size, size_t new_size)
 {
-	assert(self != NULL);
-	assert(seg_before != NULL);
-	assert(data != NULL);
+	struct ihex_arena_block *block;
 
-	if (size == 0)
-		return 0;
+	assert(self != NULL);
 
-	seg_before->data = (uint8_t *)realloc(seg_before->data, seg_before->data_size + size);
-	if (seg_before->data == NULL) {
-		self->error = IHEX_ERROR_MALLOC;
+	/* only the last allocation of current block can change its size in place */
+	block = self->arena_current;
+	if ((block == NULL) || ((uint8_t *)ptr + size != &block->data[block->used]))
+		return -1;
+	if ((new_size > size) && (new_size - size > block->size - block->used))
 		return -1;
-	}
 
-	memcpy(&seg_before->data[seg_before->data_size], data, size);
-	seg_before->data_size += size;
+	block->used = block->used - size + new_size;
 
 	return 0;
 }
 
-static int ihex_join_right(struct ihex_object *self, struct ihex_data_segment *seg_after, uint32_t adr, uint8_t *data, uint32_t size)
+static struct ihex_data_segment *ihex_alloc_segment(struct ihex_object *self)
 {
+	struct ihex_data_segment *seg;
+
 	assert(self != NULL);
-	assert(seg_after != NULL);
-	assert(data != NULL);
 
-	if (size == 0)
-		return 0;
+#ifndef IHEX_STATIC_POOL
+	if (self->arena_block_size == 0)
+		return (struct ihex_data_segment *)malloc(sizeof(struct ihex_data_segment));
+#endif
 
-	seg_after->data = (uint8_t *)realloc(seg_after->data, seg_after->data_size + size);
-	if (seg_after->data == NULL) {
-		self->error = IHEX_ERROR_MALLOC;
-		return -1;
+	if (self->free_segments != NULL) {
+		seg = self->free_segments;
+		self->free_segments = seg->next;
+		return seg;
 	}
 
-	memmove(&seg_after->data[size], seg_after->data, seg_after->data_size);
-	memcpy(seg_after->data, data, size);
-
-	seg_after->data_size += size;
-	seg_after->adr_start = adr;
+	if (self->segment_pool != NULL)
+		return NULL;
 
-	return 0;
+	return (struct ihex_data_segment *)ihex_arena_alloc(self, sizeof(struct ihex_data_segment));
 }
 
-static int ihex_insert_between(struct ihex_object *self, struct ihex_data_segment *seg_before, struct ihex_data_segment *seg_after, uint8_t *data,
-			       uint32_t size)
+static uint8_t *ihex_alloc_buffer(struct ihex_object *self, uint32_t size)
 {
 	assert(self != NULL);
-	assert(seg_before != NULL);
-	assert(seg_after != NULL);
-	assert(data != NULL);
-
-	if (size == 0)
-		return 0;
-
-	seg_before->data = (uint8_t *)realloc(seg_before->data, seg_before->data_size + size + seg_after->data_size);
-	if (seg_before->data == NULL) {
-		self->error = IHEX_ERROR_MALLOC;
-		return -1;
-	}
-
-	memcpy(&seg_before->data[seg_before->data_size], data, size);
-	seg_before->data_size += size;
-	memcpy(&seg_before->data[seg_before->data_size], seg_after->data, seg_after->data_size);
-	seg_before->data_size += seg_after->data_size;
 
-	free(seg_after->data);
-	if (seg_after->prev == NULL) {
-		self->segments = seg_after->next;
-		self->segments->prev = NULL;
-	} else {
-		seg_after->prev->next = seg_after->next;
-	}
-	free(seg_after);
+#ifndef IHEX_STATIC_POOL
+	if (self->arena_block_size == 0)
+		return (uint8_t *)malloc(size);
+#endif
 
-	return 0;
+	return (uint8_t *)ihex_arena_alloc(self, size);
 }
 
-int ihex_set_data(struct ihex_object *self, uint32_t adr, uint8_t *data, uint32_t size)
+static uint8_t *ihex_resize_buffer(struct ihex_object *self, uint8_t *buffer, uint32_t size, uint32_t new_size)
 {
-	struct ihex_data_segment *seg;
-	struct ihex_data_segment *seg_before = NULL;
-	struct ihex_data_segment *seg_after = NULL;
+	uint8_t *buffer_new;
 
 	assert(self != NULL);
-	assert(data != NULL);
 
-	if (size == 0)
-		return 0;
+#ifndef IHEX_STATIC_POOL
+	if (self->arena_block_size == 0)
+		return (uint8_t *)realloc(buffer, new_size);
+#endif
 
-	if (ihex_check_data_overlapping(self, adr, size) != 0)
-		return -1;
+	if (ihex_arena_resize(self, buffer, size, new_size) == 0)
+		return buffer;
 
-	seg = self->segments;
-	while (seg != NULL) {
-		if (adr == (seg->adr_start + seg->data_size)) {
-			seg_before = seg;
-			break;
-		}
-		seg = seg->next;
-	}
+	/* old buffer memory is reclaimed by ihex_reset */
+	buffer_new = (uint8_t *)ihex_arena_alloc(self, new_size);
+	if (buffer_new != NULL)
+		memcpy(buffer_new, buffer, (size < new_size) ? size : new_size);
 
-	seg = self->segments;
-	while (seg != NULL) {
-		if ((adr + size) == seg->adr_start) {
-			seg_after = seg;
-			break;
-		}
-		seg = seg->next;
-	}
+	return buffer_new;
+}
 
-	if ((seg_before == NULL) && (seg_after == NULL)) {
-		if (ihex_new_segment(self, adr, data, size) != 0)
-			return -1;
-	} else if ((seg_before != NULL) && (seg_after == NULL)) {
-		if (ihex_join_left(self, seg_before, data, size) != 0)
-			return -1;
-	} else if ((seg_before == NULL) && (seg_after != NULL)) {
-		if (ihex_join_right(self, seg_after, adr, data, size) != 0)
-			return -1;
-	} else {
-		if (ihex_insert_between(self, seg_before, seg_after, data, size) != 0)
-			return -1;
+static void ihex_release_buffer(struct ihex_object *self, uint8_t *buffer, uint32_t size)
+{
+	assert(self != NULL);
+
+#ifndef IHEX_STATIC_POOL
+	if (self->arena_block_size == 0) {
+		free(buffer);
+		return;
 	}
+#endif
 
-	return 0;
+	ihex_arena_resize(self, buffer, size, 0);
 }
 
-static int ihex_get_hex_nibble(const char ch, uint8_t *nibble)
+static void ihex_unlink_shared(struct ihex_data_segment *seg)
 {
-	if ((ch >= '0') && (ch <= '9')) {
-		*nibble = ch - '0';
-	} else if ((ch >= 'A') && (ch <= 'F')) {
-		*nibble = ch - 'A' + 10;
-	} else if ((ch >= 'a') && (ch <= 'f')) {
-		*nibble = ch - 'a' + 10;
-	} else {
-		return -1;
-	}
-	return 0;
+	struct ihex_data_segment *prev;
+
+	assert(seg != NULL);
+	assert(seg->shared != NULL);
+
+	prev = seg->shared;
+	while (prev->shared != seg)
+		prev = prev->shared;
+
+	/* last remaining segment becomes sole owner of buffer */
+	prev->shared = (seg->shared != prev) ? seg->shared : NULL;
+	seg->shared = NULL;
 }
 
-static int ihex_get_hex_number(char const *hex, uint8_t *byte, uint8_t size)
+static void ihex_free_segment(struct ihex_object *self, struct ihex_data_segment *seg)
 {
-	uint8_t b;
-	uint8_t *out;
+	int shared;
 
-	out = &byte[size - 1];
-	while (size > 0) {
-		if (ihex_get_hex_nibble(*hex++, &b) != 0)
-			return -1;
-		*out = b << 4;
-		if (ihex_get_hex_nibble(*hex++, &b) != 0)
-			return -1;
-		*out |= b;
-		out--;
-		size--;
+	assert(self != NULL);
+	assert(seg != NULL);
+
+	/* shared buffer is released together with its last segment */
+	shared = (seg->shared != NULL);
+	if (shared != 0)
+		ihex_unlink_shared(seg);
+
+#ifndef IHEX_STATIC_POOL
+	if (self->arena_block_size == 0) {
+		if (shared == 0)
+			free(seg->buffer);
+		free(seg);
+		return;
 	}
+#endif
 
-	return 0;
+	if (shared == 0)
+		ihex_release_buffer(self, seg->buffer, seg->capacity);
+	seg->next = self->free_segments;
+	self->free_segments = seg;
 }
 
-static int ihex_new_record(struct ihex_object *self, uint8_t size, uint16_t adr, uint8_t type, uint8_t *data)
+static void ihex_free_segments(struct ihex_object *self)
 {
+#ifndef IHEX_STATIC_POOL
+	struct ihex_data_segment *seg;
+	struct ihex_data_segment *seg_next;
+
 	assert(self != NULL);
 
-	switch (type) {
-	case 0x00:
-		if (ihex_set_data(self, (uint32_t)adr + self->extended_address, data, size) != 0)
-			return -1;
-		break;
-	case 0x01:
-		self->finished_flag = 1;
-		break;
-	case 0x04:
-		if (adr != 0) {
-			self->error = IHEX_ERROR_ADDRESS_FIELD;
-			return -1;
+	if (self->arena_block_size == 0) {
+		seg = self->segments;
+		while (seg != NULL) {
+			seg_next = seg->next;
+			ihex_free_segment(self, seg);
+			seg = seg_next;
 		}
-		self->extended_address = data[0] << 24 | data[1] << 16;
-		break;
-	case 0x05:
-		break;
-	default:
-		self->error = IHEX_ERROR_RECORD_TYPE;
-		return -1;
 	}
-	return 0;
+#endif
+
+	self->segments = NULL;
+	self->index_root = NULL;
+	self->index_count = 0;
+	self->index_hint = NULL;
+	self->pad_span_count = 0;
+	self->pad_run_size = 0;
+	self->free_segments = NULL;
+	if (self->segment_pool != NULL)
+		ihex_pool_release_segments(self);
 }
 
-static int ihex_parse_record(struct ihex_object *self, const char *record_line)
+void ihex_reset(struct ihex_object *self)
 {
-	uint8_t data_size;
-	uint8_t index;
-	uint16_t address;
-	uint8_t record_type;
-	uint8_t checksum;
-	uint8_t sum;
-	uint8_t *data;
-	char ch;
-
-	size_t line_length;
+	struct ihex_arena_block *block;
 
 	assert(self != NULL);
-	assert(record_line != NULL);
 
-	line_length = strlen(record_line);
+	ihex_free_segments(self);
 
-	if (line_length < 12) {
-		self->error = IHEX_ERROR_LINE_LENGTH;
+	for (block = self->arena; block != NULL; block = block->next)
+		block->used = 0;
+	self->arena_current = self->arena;
+
+	self->log_count = 0;
+	self->log_data_size = 0;
+	self->extended_address = 0;
+	self->finished_flag = 0;
+	self->line_length = 0;
+	self->error = IHEX_NO_ERROR;
+}
+
+#ifndef IHEX_STATIC_POOL
+void ihex_delete(struct ihex_object *self)
+{
+	struct ihex_arena_block *block;
+	struct ihex_arena_block *block_next;
+
+	assert(self != NULL);
+	assert(self->segment_pool == NULL);
+
+	ihex_free_segments(self);
+
+	block = self->arena;
+	while (block != NULL) {
+		block_next = block->next;
+		free(block->data);
+		free(block);
+		block = block_next;
+	}
+
+	free(self->log);
+	free(self->log_data);
+	free(self->pad_spans);
+	free(self);
+}
+#endif
+
+const char *ihex_get_error_string(struct ihex_object *self)
+{
+	switch (self->error) {
+	case IHEX_NO_ERROR:
+		return NULL;
+	case IHEX_ERROR_DATA_OVERLAPPING:
+		return "Data segments overlapping";
+	case IHEX_ERROR_NO_EOF_LINE:
+		return "No EOF line";
+	case IHEX_ERROR_PARSING_START_LINE:
+		return "Wrong start line char";
+	case IHEX_ERROR_PARSING_HEX_ENCODE:
+		return "Wrong ascii hex encoding";
+	case IHEX_ERROR_PARSING_END_LINE:
+		return "Wrong EOL char";
+	case IHEX_ERROR_ADDRESS_FIELD:
+		return "Incorrect address field";
+	case IHEX_ERROR_LINE_LENGTH:
+		return "Line length error";
+	case IHEX_ERROR_CHECKSUM:
+		return "Checksum error";
+	case IHEX_ERROR_RECORD_TYPE:
+		return "Unsupported record type";
+	case IHEX_ERROR_MALLOC:
+		return "Memory allocation error";
+	case IHEX_ERROR_DUMP:
+		return "Write dump stream error";
+	case IHEX_ERROR_FILE:
+		return "File access error";
+	case IHEX_ERROR_VIEW:
+		return "Requested data are not inside of one data segment";
+	case IHEX_ERROR_POOL:
+		return "Static memory pool exhausted";
+	default:
+		return "Unknown error";
+	}
+	return NULL;
+}
+
+#ifdef IHEX_STATS
+static uint64_t ihex_stats_clock(void)
+{
+#if defined(__unix__) || defined(__APPLE__)
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#else
+	/* no portable monotonic clock, phase times stay zero */
+	return 0;
+#endif
+}
+
+void ihex_get_stats(struct ihex_object *self, struct ihex_stats *stats)
+{
+	assert(self != NULL);
+	assert(stats != NULL);
+
+	*stats = self->stats;
+	stats->segments = self->index_count;
+}
+
+void ihex_clear_stats(struct ihex_object *self)
+{
+	assert(self != NULL);
+
+	memset(&self->stats, 0, sizeof(self->stats));
+}
+#endif
+
+static int ihex_index_height(const struct ihex_data_segment *node)
+{
+	return (node != NULL) ? node->height : 0;
+}
+
+static void ihex_index_update(struct ihex_data_segment *node)
+{
+	int left;
+	int right;
+
+	assert(node != NULL);
+
+	left = ihex_index_height(node->left);
+	right = ihex_index_height(node->right);
+	node->height = ((left > right) ? left : right) + 1;
+}
+
+static void ihex_index_replace(struct ihex_object *self, struct ihex_data_segment *old, struct ihex_data_segment *node)
+{
+	assert(self != NULL);
+	assert(old != NULL);
+
+	/* node takes place of old under its parent, children are left to caller */
+	if (old->parent == NULL) {
+		self->index_root = node;
+	} else if (old->parent->left == old) {
+		old->parent->left = node;
+	} else {
+		old->parent->right = node;
+	}
+	if (node != NULL)
+		node->parent = old->parent;
+}
+
+static struct ihex_data_segment *ihex_index_rotate_left(struct ihex_object *self, struct ihex_data_segment *node)
+{
+	struct ihex_data_segment *pivot;
+
+	assert(self != NULL);
+	assert(node != NULL);
+	assert(node->right != NULL);
+
+	pivot = node->right;
+	ihex_index_replace(self, node, pivot);
+	node->right = pivot->left;
+	if (node->right != NULL)
+		node->right->parent = node;
+	pivot->left = node;
+	node->parent = pivot;
+	ihex_index_update(node);
+	ihex_index_update(pivot);
+
+	return pivot;
+}
+
+static struct ihex_data_segment *ihex_index_rotate_right(struct ihex_object *self, struct ihex_data_segment *node)
+{
+	struct ihex_data_segment *pivot;
+
+	assert(self != NULL);
+	assert(node != NULL);
+	assert(node->left != NULL);
+
+	pivot = node->left;
+	ihex_index_replace(self, node, pivot);
+	node->left = pivot->right;
+	if (node->left != NULL)
+		node->left->parent = node;
+	pivot->right = node;
+	node->parent = pivot;
+	ihex_index_update(node);
+	ihex_index_update(pivot);
+
+	return pivot;
+}
+
+static void ihex_index_rebalance(struct ihex_object *self, struct ihex_data_segment *node)
+{
+	int balance;
+
+	assert(self != NULL);
+
+	/* heights are fixed from changed node up to root, subtrees differing by more than one level are rotated */
+	while (node != NULL) {
+		ihex_index_update(node);
+		balance = ihex_index_height(node->left) - ihex_index_height(node->right);
+		if (balance > 1) {
+			if (ihex_index_height(node->left->left) < ihex_index_height(node->left->right))
+				ihex_index_rotate_left(self, node->left);
+			node = ihex_index_rotate_right(self, node);
+		} else if (balance < -1) {
+			if (ihex_index_height(node->right->right) < ihex_index_height(node->right->left))
+				ihex_index_rotate_right(self, node->right);
+			node = ihex_index_rotate_left(self, node);
+		}
+		node = node->parent;
+	}
+}
+
+static struct ihex_data_segment *ihex_find_segment(struct ihex_object *self, uint32_t adr)
+{
+	struct ihex_data_segment *hint;
+	struct ihex_data_segment *node;
+	struct ihex_data_segment *found;
+
+	assert(self != NULL);
+
+	/* fast path for monotonic (ascending or descending) input */
+	hint = self->index_hint;
+	if (hint != NULL) {
+		IHEX_STATS_ADD(self, nodes_visited, 2);
+		if (hint->adr_start <= adr) {
+			if ((hint->next == NULL) || (hint->next->adr_start > adr))
+				return hint;
+		} else {
+			if ((hint->prev == NULL) || (hint->prev->adr_start <= adr))
+				return hint->prev;
+		}
+	}
+
+	/* returns last segment with starting address lower or equal to adr, NULL if there is none */
+	found = NULL;
+	node = self->index_root;
+	while (node != NULL) {
+		IHEX_STATS_ADD(self, nodes_visited, 1);
+		if (node->adr_start <= adr) {
+			found = node;
+			node = node->right;
+		} else {
+			node = node->left;
+		}
+	}
+
+	return found;
+}
+
+static struct ihex_data_segment *ihex_next_segment(struct ihex_object *self, struct ihex_data_segment *seg)
+{
+	assert(self != NULL);
+
+	/* segment following position returned by ihex_find_segment */
+	return (seg != NULL) ? seg->next : self->segments;
+}
+
+static void ihex_index_insert(struct ihex_object *self, struct ihex_data_segment *prev, struct ihex_data_segment *seg)
+{
+	struct ihex_data_segment *next;
+
+	assert(self != NULL);
+	assert(seg != NULL);
+
+	/* called before seg is linked to list, prev is its predecessor (NULL if seg becomes first) */
+	next = ihex_next_segment(self, prev);
+	seg->left = NULL;
+	seg->right = NULL;
+	seg->height = 1;
+	if (self->index_root == NULL) {
+		seg->parent = NULL;
+		self->index_root = seg;
+	} else if ((prev != NULL) && (prev->right == NULL)) {
+		seg->parent = prev;
+		prev->right = seg;
+	} else {
+		/* successor is leftmost node of predecessor right subtree (or lowest node), so its left link is free */
+		assert(next != NULL);
+		assert(next->left == NULL);
+		seg->parent = next;
+		next->left = seg;
+	}
+	self->index_count++;
+
+	ihex_index_rebalance(self, seg->parent);
+}
+
+static void ihex_index_remove(struct ihex_object *self, struct ihex_data_segment *seg)
+{
+	struct ihex_data_segment *next;
+	struct ihex_data_segment *changed;
+
+	assert(self != NULL);
+	assert(seg != NULL);
+	assert(self->index_count > 0);
+
+	/* called before seg is unlinked from list, its successor replaces it when it has both children */
+	if (seg->left == NULL) {
+		changed = seg->parent;
+		ihex_index_replace(self, seg, seg->right);
+	} else if (seg->right == NULL) {
+		changed = seg->parent;
+		ihex_index_replace(self, seg, seg->left);
+	} else {
+		next = seg->next;
+		if (next->parent != seg) {
+			changed = next->parent;
+			ihex_index_replace(self, next, next->right);
+			next->right = seg->right;
+			next->right->parent = next;
+		} else {
+			changed = next;
+		}
+		ihex_index_replace(self, seg, next);
+		next->left = seg->left;
+		next->left->parent = next;
+	}
+	self->index_count--;
+	if (self->index_hint == seg)
+		self->index_hint = NULL;
+
+	ihex_index_rebalance(self, changed);
+}
+
+static struct ihex_data_segment *ihex_index_build(struct ihex_data_segment **seg, uint32_t count)
+{
+	struct ihex_data_segment *node;
+	struct ihex_data_segment *left;
+
+	assert(seg != NULL);
+
+	/* balanced tree from count list segments starting at *seg, *seg is moved behind them */
+	if (count == 0)
+		return NULL;
+
+	left = ihex_index_build(seg, count / 2);
+	node = *seg;
+	*seg = node->next;
+	node->parent = NULL;
+	node->left = left;
+	if (left != NULL)
+		left->parent = node;
+	node->right = ihex_index_build(seg, count - count / 2 - 1);
+	if (node->right != NULL)
+		node->right->parent = node;
+	ihex_index_update(node);
+
+	return node;
+}
+
+static void ihex_index_rebuild(struct ihex_object *self)
+{
+	struct ihex_data_segment *seg;
+	uint32_t count;
+
+	assert(self != NULL);
+
+	/* used after bulk changes of segments list */
+	count = 0;
+	for (seg = self->segments; seg != NULL; seg = seg->next)
+		count++;
+	seg = self->segments;
+	self->index_root = ihex_index_build(&seg, count);
+	self->index_count = count;
+	self->index_hint = NULL;
+}
+
+static uint32_t ihex_find_pad_span(struct ihex_object *self, uint32_t adr)
+{
+	uint32_t low;
+	uint32_t high;
+	uint32_t mid;
+
+	assert(self != NULL);
+
+	/* returns number of elided runs with starting address lower or equal to adr */
+	low = 0;
+	high = self->pad_span_count;
+	while (low < high) {
+		mid = low + (high - low) / 2;
+		if (self->pad_spans[mid].adr_start <= adr) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+static int ihex_pad_span_overlapping(struct ihex_object *self, uint32_t adr, uint32_t size)
+{
+	struct ihex_pad_span *span;
+	uint32_t pos;
+
+	assert(self != NULL);
+	assert(size > 0);
+
+	if (self->pad_span_count == 0)
+		return 0;
+
+	pos = ihex_find_pad_span(self, adr);
+	if (pos > 0) {
+		span = &self->pad_spans[pos - 1];
+		if (adr <= span->adr_start + span->size - 1)
+			return 1;
+	}
+	if ((pos < self->pad_span_count) && (adr + size - 1 >= self->pad_spans[pos].adr_start))
+		return 1;
+
+	return 0;
+}
+
+static int ihex_check_data_overlapping(struct ihex_object *self, struct ihex_data_segment *prev, uint32_t adr, uint32_t size)
+{
+	struct ihex_data_segment *seg;
+
+	assert(self != NULL);
+
+	if (size == 0)
+		return 0;
+
+	/* elided pad byte runs are assigned addresses as well */
+	if (ihex_pad_span_overlapping(self, adr, size) != 0) {
+		self->error = IHEX_ERROR_DATA_OVERLAPPING;
+		return -1;
+	}
+
+	/* only direct neighbours of the position found in index can overlap */
+	if (prev != NULL) {
+		IHEX_STATS_ADD(self, nodes_visited, 1);
+		if (adr <= prev->adr_start + prev->data_size - 1) {
+			self->error = IHEX_ERROR_DATA_OVERLAPPING;
+			return -1;
+		}
+	}
+	seg = ihex_next_segment(self, prev);
+	if (seg != NULL) {
+		IHEX_STATS_ADD(self, nodes_visited, 1);
+		if (adr + size - 1 >= seg->adr_start) {
+			self->error = IHEX_ERROR_DATA_OVERLAPPING;
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int ihex_insert_pad_span(struct ihex_object *self, uint32_t pos, uint32_t adr, uint32_t size)
+{
+#ifndef IHEX_STATIC_POOL
+	struct ihex_pad_span *spans;
+	uint32_t capacity;
+#endif
+
+	assert(self != NULL);
+	assert(pos <= self->pad_span_count);
+
+#ifndef IHEX_STATIC_POOL
+	if (self->pad_span_count == self->pad_span_capacity) {
+		capacity = (self->pad_span_capacity != 0) ? self->pad_span_capacity * 2 : 16;
+		spans = (struct ihex_pad_span *)realloc(self->pad_spans, capacity * sizeof(struct ihex_pad_span));
+		if (spans == NULL) {
+			self->error = IHEX_ERROR_MALLOC;
+			return -1;
+		}
+		self->pad_spans = spans;
+		self->pad_span_capacity = capacity;
+	}
+#endif
+	if (self->pad_span_count == self->pad_span_capacity) {
+		self->error = IHEX_ERROR_POOL;
+		return -1;
+	}
+
+	memmove(&self->pad_spans[pos + 1], &self->pad_spans[pos], (self->pad_span_count - pos) * sizeof(struct ihex_pad_span));
+	self->pad_spans[pos].adr_start = adr;
+	self->pad_spans[pos].size = size;
+	self->pad_span_count++;
+
+	return 0;
+}
+
+static void ihex_remove_pad_span(struct ihex_object *self, uint32_t pos)
+{
+	assert(self != NULL);
+	assert(pos < self->pad_span_count);
+
+	memmove(&self->pad_spans[pos], &self->pad_spans[pos + 1], (self->pad_span_count - pos - 1) * sizeof(struct ihex_pad_span));
+	self->pad_span_count--;
+}
+
+static int ihex_add_pad_span(struct ihex_object *self, uint32_t adr, uint32_t size)
+{
+	struct ihex_pad_span *spans;
+	uint32_t pos;
+
+	assert(self != NULL);
+	assert(size > 0);
+
+	if (ihex_check_data_overlapping(self, ihex_find_segment(self, adr), adr, size) != 0)
+		return -1;
+
+	/* run touching its neighbours is joined with them */
+	spans = self->pad_spans;
+	pos = ihex_find_pad_span(self, adr);
+	if ((pos > 0) && (spans[pos - 1].adr_start + spans[pos - 1].size == adr)) {
+		spans[pos - 1].size += size;
+		if ((pos < self->pad_span_count) && (adr + size == spans[pos].adr_start)) {
+			spans[pos - 1].size += spans[pos].size;
+			ihex_remove_pad_span(self, pos);
+		}
+		return 0;
+	}
+	if ((pos < self->pad_span_count) && (adr + size == spans[pos].adr_start)) {
+		spans[pos].adr_start = adr;
+		spans[pos].size += size;
+		return 0;
+	}
+
+	return ihex_insert_pad_span(self, pos, adr, size);
+}
+
+static int ihex_cut_pad_spans(struct ihex_object *self, uint32_t adr, uint32_t size)
+{
+	struct ihex_pad_span *span;
+	uint64_t end;
+	uint64_t span_end;
+	uint32_t pos;
+
+	assert(self != NULL);
+
+	if ((self->pad_span_count == 0) || (size == 0))
+		return 0;
+
+	/* range stops being elided, it is written or erased by caller */
+	end = (uint64_t)adr + size;
+	pos = ihex_find_pad_span(self, adr);
+	if ((pos > 0) && (adr - self->pad_spans[pos - 1].adr_start < self->pad_spans[pos - 1].size))
+		pos--;
+
+	while ((pos < self->pad_span_count) && (self->pad_spans[pos].adr_start < end)) {
+		span = &self->pad_spans[pos];
+		span_end = (uint64_t)span->adr_start + span->size;
+		if (span->adr_start < adr) {
+			span->size = adr - span->adr_start;
+			if (span_end > end)
+				return ihex_insert_pad_span(self, pos + 1, (uint32_t)end, (uint32_t)(span_end - end));
+			pos++;
+		} else if (span_end <= end) {
+			ihex_remove_pad_span(self, pos);
+		} else {
+			span->adr_start = (uint32_t)end;
+			span->size = (uint32_t)(span_end - end);
+			break;
+		}
+	}
+
+	return 0;
+}
+
+static void ihex_link_segment(struct ihex_object *self, struct ihex_data_segment *prev, struct ihex_data_segment *seg)
+{
+	assert(self != NULL);
+	assert(seg != NULL);
+
+	ihex_index_insert(self, prev, seg);
+
+	seg->prev = prev;
+	seg->next = ihex_next_segment(self, prev);
+	if (seg->prev != NULL) {
+		seg->prev->next = seg;
+	} else {
+		self->segments = seg;
+	}
+	if (seg->next != NULL)
+		seg->next->prev = seg;
+
+	self->index_hint = seg;
+}
+
+static struct ihex_data_segment *ihex_create_segment(struct ihex_object *self, uint32_t adr, uint32_t size)
+{
+	struct ihex_data_segment *seg_new;
+
+	assert(self != NULL);
+
+	seg_new = ihex_alloc_segment(self);
+	if (seg_new == NULL) {
+		ihex_set_alloc_error(self);
+		return NULL;
+	}
+	seg_new->buffer = ihex_alloc_buffer(self, size);
+	seg_new->data = seg_new->buffer;
+	seg_new->capacity = size;
+	if (seg_new->buffer == NULL) {
+		seg_new->capacity = 0;
+		ihex_free_segment(self, seg_new);
+		ihex_set_alloc_error(self);
+		return NULL;
+	}
+	seg_new->adr_start = adr;
+	seg_new->data_size = size;
+	seg_new->shared = NULL;
+
+	return seg_new;
+}
+
+static int ihex_new_segment(struct ihex_object *self, struct ihex_data_segment *prev, uint32_t adr, uint8_t *data, uint32_t size)
+{
+	struct ihex_data_segment *seg_new;
+
+	assert(self != NULL);
+	assert(data != NULL);
+
+	if (size == 0)
+		return 0;
+
+	seg_new = ihex_create_segment(self, adr, size);
+	if (seg_new == NULL)
+		return -1;
+
+	memcpy(seg_new->data, data, size);
+
+	ihex_link_segment(self, prev, seg_new);
+
+	return 0;
+}
+
+static uint32_t ihex_grow_capacity(uint32_t capacity, uint32_t required)
+{
+	/* geometric growth keeps adding data record by record linear in total */
+	capacity = (capacity <= 0x7FFFFFFF) ? capacity * 2 : 0xFFFFFFFF;
+	if (capacity < required)
+		capacity = required;
+	return capacity;
+}
+
+static int ihex_unshare_buffer(struct ihex_object *self, struct ihex_data_segment *seg, uint32_t head, uint32_t tail)
+{
+	uint8_t *buffer;
+	uint32_t capacity;
+
+	assert(self != NULL);
+	assert(seg != NULL);
+	assert(seg->shared != NULL);
+
+	/* space around data of shared buffer belongs to other segments, data are moved to own buffer */
+	capacity = head + seg->data_size + tail;
+	buffer = ihex_alloc_buffer(self, capacity);
+	if (buffer == NULL) {
+		ihex_set_alloc_error(self);
+		return -1;
+	}
+	memcpy(&buffer[head], seg->data, seg->data_size);
+	ihex_unlink_shared(seg);
+	seg->buffer = buffer;
+	seg->data = &buffer[head];
+	seg->capacity = capacity;
+
+	return 0;
+}
+
+static int ihex_reserve_tail(struct ihex_object *self, struct ihex_data_segment *seg, uint32_t size)
+{
+	uint8_t *buffer;
+	uint32_t head;
+	uint32_t capacity;
+
+	assert(self != NULL);
+	assert(seg != NULL);
+
+	if (seg->shared != NULL)
+		return ihex_unshare_buffer(self, seg, 0, size);
+
+	head = seg->data - seg->buffer;
+	if (head + seg->data_size + size <= seg->capacity)
+		return 0;
+
+	capacity = ihex_grow_capacity(seg->capacity, head + seg->data_size + size);
+
+	buffer = ihex_resize_buffer(self, seg->buffer, seg->capacity, capacity);
+	if ((buffer == NULL) && (self->segment_pool != NULL)) {
+		/* static pool may still have room for exact size */
+		capacity = head + seg->data_size + size;
+		buffer = ihex_resize_buffer(self, seg->buffer, seg->capacity, capacity);
+	}
+	if (buffer == NULL) {
+		ihex_set_alloc_error(self);
+		return -1;
+	}
+	seg->buffer = buffer;
+	seg->data = &buffer[head];
+	seg->capacity = capacity;
+	IHEX_STATS_ADD(self, reallocs, 1);
+
+	return 0;
+}
+
+static int ihex_reserve_head(struct ihex_object *self, struct ihex_data_segment *seg, uint32_t size)
+{
+	uint8_t *buffer;
+	uint32_t head;
+	uint32_t tail;
+	uint32_t capacity;
+
+	assert(self != NULL);
+	assert(seg != NULL);
+
+	if (seg->shared != NULL)
+		return ihex_unshare_buffer(self, seg, size, 0);
+
+	head = seg->data - seg->buffer;
+	if (head >= size)
+		return 0;
+
+	/* all added space goes in front of data, so next prepends are just pointer moves */
+	tail = seg->capacity - head - seg->data_size;
+	capacity = ihex_grow_capacity(seg->capacity, size + seg->data_size + tail);
+	head = capacity - seg->data_size - tail;
+
+	buffer = ihex_alloc_buffer(self, capacity);
+	if ((buffer == NULL) && (self->segment_pool != NULL)) {
+		/* static pool may still have room for exact size */
+		capacity = size + seg->data_size + tail;
+		head = size;
+		buffer = ihex_alloc_buffer(self, capacity);
+	}
+	if (buffer == NULL) {
+		ihex_set_alloc_error(self);
+		return -1;
+	}
+	memcpy(&buffer[head], seg->data, seg->data_size);
+	ihex_release_buffer(self, seg->buffer, seg->capacity);
+	seg->buffer = buffer;
+	seg->data = &buffer[head];
+	seg->capacity = capacity;
+	IHEX_STATS_ADD(self, reallocs, 1);
+
+	return 0;
+}
+
+static int ihex_shrink_data(struct ihex_object *self)
+{
+#ifndef IHEX_STATIC_POOL
+	struct ihex_data_segment *seg;
+	uint8_t *buffer;
+#endif
+
+	assert(self != NULL);
+
+#ifndef IHEX_STATIC_POOL
+
+	/* arena memory is reclaimed only as a whole, shrinking would not release anything */
+	if (self->arena_block_size != 0)
+		return 0;
+
+	seg = self->segments;
+	while (seg != NULL) {
+		if ((seg->capacity > seg->data_size) && (seg->shared == NULL)) {
+			if (seg->data != seg->buffer) {
+				memmove(seg->buffer, seg->data, seg->data_size);
+				seg->data = seg->buffer;
+			}
+			buffer = (uint8_t *)realloc(seg->buffer, seg->data_size);
+			if (buffer == NULL) {
+				self->error = IHEX_ERROR_MALLOC;
+				return -1;
+			}
+			seg->buffer = buffer;
+			seg->data = buffer;
+			seg->capacity = seg->data_size;
+		}
+		seg = seg->next;
+	}
+#endif
+
+	return 0;
+}
+
+static int ihex_join_left(struct ihex_object *self, struct ihex_data_segment *seg_before, uint8_t *data, uint32_t size)
+{
+	assert(self != NULL);
+	assert(seg_before != NULL);
+	assert(data != NULL);
+
+	if (size == 0)
+		return 0;
+
+	if (ihex_reserve_tail(self, seg_before, size) != 0)
+		return -1;
+
+	memcpy(&seg_before->data[seg_before->data_size], data, size);
+	seg_before->data_size += size;
+	IHEX_STATS_ADD(self, join_left_bytes, size);
+
+	return 0;
+}
+
+static int ihex_join_right(struct ihex_object *self, struct ihex_data_segment *seg_after, uint32_t adr, uint8_t *data, uint32_t size)
+{
+#ifdef IHEX_STATS
+	uint8_t *buffer;
+#endif
+
+	assert(self != NULL);
+	assert(seg_after != NULL);
+	assert(data != NULL);
+
+	if (size == 0)
+		return 0;
+
+#ifdef IHEX_STATS
+	/* data already in segment are copied when it moves to bigger buffer */
+	buffer = seg_after->buffer;
+#endif
+	if (ihex_reserve_head(self, seg_after, size) != 0)
+		return -1;
+	IHEX_STATS_ADD(self, join_right_bytes, (seg_after->buffer != buffer) ? size + seg_after->data_size : size);
+
+	seg_after->data -= size;
+	memcpy(seg_after->data, data, size);
+
+	seg_after->data_size += size;
+	seg_after->adr_start = adr;
+
+	return 0;
+}
+
+static void ihex_append_next(struct ihex_object *self, struct ihex_data_segment *seg_before, struct ihex_data_segment *seg_after)
+{
+	assert(self != NULL);
+	assert(seg_before != NULL);
+	assert(seg_after != NULL);
+
+	/* space for data of next segment must be already reserved */
+	memcpy(&seg_before->data[seg_before->data_size], seg_after->data, seg_after->data_size);
+	seg_before->data_size += seg_after->data_size;
+
+	ihex_index_remove(self, seg_after);
+	self->index_hint = seg_before;
+
+	seg_before->next = seg_after->next;
+	if (seg_after->next != NULL)
+		seg_after->next->prev = seg_before;
+
+	ihex_free_segment(self, seg_after);
+}
+
+static int ihex_insert_between(struct ihex_object *self, struct ihex_data_segment *seg_before, struct ihex_data_segment *seg_after, uint8_t *data,
+			       uint32_t size)
+{
+	assert(self != NULL);
+	assert(seg_before != NULL);
+	assert(seg_after != NULL);
+	assert(data != NULL);
+
+	if (size == 0)
+		return 0;
+
+	if (ihex_reserve_tail(self, seg_before, size + seg_after->data_size) != 0)
+		return -1;
+
+	memcpy(&seg_before->data[seg_before->data_size], data, size);
+	seg_before->data_size += size;
+	IHEX_STATS_ADD(self, insert_between_bytes, size + seg_after->data_size);
+
+	ihex_append_next(self, seg_before, seg_after);
+
+	return 0;
+}
+
+int ihex_set_data(struct ihex_object *self, uint32_t adr, uint8_t *data, uint32_t size)
+{
+	struct ihex_data_segment *prev;
+	struct ihex_data_segment *next;
+	struct ihex_data_segment *seg_before = NULL;
+	struct ihex_data_segment *seg_after = NULL;
+
+	assert(self != NULL);
+	assert(data != NULL);
+
+	if (size == 0)
+		return 0;
+
+	prev = ihex_find_segment(self, adr);
+
+	if (ihex_check_data_overlapping(self, prev, adr, size) != 0)
+		return -1;
+
+	if ((prev != NULL) && (adr == (prev->adr_start + prev->data_size)))
+		seg_before = prev;
+
+	next = ihex_next_segment(self, prev);
+	if ((next != NULL) && ((adr + size) == next->adr_start))
+		seg_after = next;
+
+	if ((seg_before == NULL) && (seg_after == NULL)) {
+		if (ihex_new_segment(self, prev, adr, data, size) != 0)
+			return -1;
+	} else if ((seg_before != NULL) && (seg_after == NULL)) {
+		if (ihex_join_left(self, seg_before, data, size) != 0)
+			return -1;
+		self->index_hint = seg_before;
+	} else if ((seg_before == NULL) && (seg_after != NULL)) {
+		if (ihex_join_right(self, seg_after, adr, data, size) != 0)
+			return -1;
+		self->index_hint = seg_after;
+	} else {
+		if (ihex_insert_between(self, seg_before, seg_after, data, size) != 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+#ifndef IHEX_STATIC_POOL
+static int ihex_compare_vec(const void *a, const void *b)
+{
+	uint32_t adr_a = (*(const struct ihex_data_vec *const *)a)->adr;
+	uint32_t adr_b = (*(const struct ihex_data_vec *const *)b)->adr;
+
+	return (adr_a > adr_b) - (adr_a < adr_b);
+}
+#endif
+
+static const struct ihex_data_vec *ihex_vec_entry(const struct ihex_data_vec *vec, const struct ihex_data_vec **order, uint32_t i)
+{
+	return (order != NULL) ? order[i] : &vec[i];
+}
+
+static uint8_t *ihex_insert_space(struct ihex_object *self, uint32_t adr, uint32_t size)
+{
+	struct ihex_data_segment *seg_before = NULL;
+	struct ihex_data_segment *seg_after = NULL;
+	struct ihex_data_segment *seg_new;
+	struct ihex_data_segment *prev;
+	struct ihex_data_segment *next;
+	uint8_t *dst;
+
+	assert(self != NULL);
+	assert(size > 0);
+
+	/* unused address range is added to neighbour segments (or new one), caller fills returned space */
+	prev = ihex_find_segment(self, adr);
+	if ((prev != NULL) && (adr == (prev->adr_start + prev->data_size)))
+		seg_before = prev;
+	next = ihex_next_segment(self, prev);
+	if ((next != NULL) && ((adr + size) == next->adr_start))
+		seg_after = next;
+
+	if (seg_before != NULL) {
+		if (ihex_reserve_tail(self, seg_before, size + ((seg_after != NULL) ? seg_after->data_size : 0)) != 0)
+			return NULL;
+		dst = &seg_before->data[seg_before->data_size];
+		seg_before->data_size += size;
+		self->index_hint = seg_before;
+		if (seg_after != NULL)
+			ihex_append_next(self, seg_before, seg_after);
+	} else if (seg_after != NULL) {
+		if (ihex_reserve_head(self, seg_after, size) != 0)
+			return NULL;
+		seg_after->data -= size;
+		seg_after->data_size += size;
+		seg_after->adr_start = adr;
+		self->index_hint = seg_after;
+		dst = seg_after->data;
+	} else {
+		seg_new = ihex_create_segment(self, adr, size);
+		if (seg_new == NULL)
+			return NULL;
+		ihex_link_segment(self, prev, seg_new);
+		dst = seg_new->data;
+	}
+
+	return dst;
+}
+
+static int ihex_set_data_run(struct ihex_object *self, const struct ihex_data_vec *vec, const struct ihex_data_vec **order, uint32_t first,
+			     uint32_t last, uint32_t size)
+{
+	const struct ihex_data_vec *entry;
+	uint8_t *dst;
+	uint32_t adr;
+	uint32_t i;
+
+	assert(self != NULL);
+
+	/* destination space of whole run is reserved once */
+	adr = ihex_vec_entry(vec, order, first)->adr;
+	dst = ihex_insert_space(self, adr, size);
+	if (dst == NULL)
+		return -1;
+
+	for (i = first; i < last; i++) {
+		entry = ihex_vec_entry(vec, order, i);
+		if (entry->size != 0)
+			memcpy(&dst[entry->adr - adr], entry->data, entry->size);
+	}
+
+	return 0;
+}
+
+static int ihex_set_data_sorted(struct ihex_object *self, const struct ihex_data_vec *vec, const struct ihex_data_vec **order, uint32_t count)
+{
+	const struct ihex_data_vec *entry;
+	struct ihex_data_segment *prev;
+	struct ihex_data_segment *next;
+	uint32_t first;
+	uint32_t adr;
+	uint32_t i;
+	uint64_t end;
+	int pass;
+
+	assert(self != NULL);
+
+	/* first pass only validates, on any overlap nothing is changed and sequential calls report error */
+	for (pass = 0; pass < 2; pass++) {
+		i = 0;
+		while (i < count) {
+			entry = ihex_vec_entry(vec, order, i);
+			if (entry->size == 0) {
+				i++;
+				continue;
+			}
+
+			/* run of touching entries becomes one continuous block, empty entries are ignored as by ihex_set_data */
+			first = i;
+			adr = entry->adr;
+			end = (uint64_t)adr + entry->size;
+			for (i++; i < count; i++) {
+				entry = ihex_vec_entry(vec, order, i);
+				if (entry->size == 0)
+					continue;
+				if (entry->adr > end)
+					break;
+				if (entry->adr < end)
+					return 1;
+				end += entry->size;
+			}
+			if (end > UINT64_C(0x100000000))
+				return 1;
+
+			if (pass == 0) {
+				prev = ihex_find_segment(self, adr);
+				if ((prev != NULL) && (adr < (uint64_t)prev->adr_start + prev->data_size))
+					return 1;
+				next = ihex_next_segment(self, prev);
+				if ((next != NULL) && (end > next->adr_start))
+					return 1;
+				if (ihex_pad_span_overlapping(self, adr, (uint32_t)(end - adr)) != 0)
+					return 1;
+			} else if (ihex_set_data_run(self, vec, order, first, i, (uint32_t)(end - adr)) != 0) {
+				return -1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+int ihex_set_data_vec(struct ihex_object *self, const struct ihex_data_vec *vec, uint32_t count)
+{
+#ifndef IHEX_STATIC_POOL
+	const struct ihex_data_vec **order;
+#endif
+	uint32_t i;
+	int s;
+
+	assert(self != NULL);
+	assert((vec != NULL) || (count == 0));
+
+	/* entries not sorted by address are sorted through array of pointers */
+	for (i = 1; i < count; i++) {
+		if (vec[i].adr < vec[i - 1].adr)
+			break;
+	}
+	if (i >= count) {
+		s = ihex_set_data_sorted(self, vec, NULL, count);
+		if (s <= 0)
+			return s;
+	} else {
+#ifndef IHEX_STATIC_POOL
+		order = (const struct ihex_data_vec **)malloc((size_t)count * sizeof(struct ihex_data_vec *));
+		if (order != NULL) {
+			for (i = 0; i < count; i++)
+				order[i] = &vec[i];
+			qsort(order, count, sizeof(struct ihex_data_vec *), ihex_compare_vec);
+			s = ihex_set_data_sorted(self, vec, order, count);
+			free(order);
+			if (s <= 0)
+				return s;
+		}
+#endif
+	}
+
+	/* overlapping data (or no memory for sorting) are added by sequential calls with the same result */
+	for (i = 0; i < count; i++) {
+		if (ihex_set_data(self, vec[i].adr, (uint8_t *)vec[i].data, vec[i].size) != 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+static uint32_t ihex_range_below_top(uint32_t adr, uint32_t size)
+{
+	/* part of range below end of 4 GiB address space, rest wraps around to address 0 */
+	return ((adr != 0) && (size > (uint32_t)0 - adr)) ? (uint32_t)0 - adr : size;
+}
+
+static int ihex_write_range(struct ihex_object *self, uint32_t adr, uint32_t size, const uint8_t *data, uint8_t byte)
+{
+	struct ihex_data_segment *seg;
+	struct ihex_data_segment *next;
+	uint8_t *dst;
+	uint32_t length;
+
+	assert(self != NULL);
+
+	if (ihex_cut_pad_spans(self, adr, size) != 0)
+		return -1;
+
+	while (size > 0) {
+		seg = ihex_find_segment(self, adr);
+		if ((seg != NULL) && (adr - seg->adr_start < seg->data_size)) {
+			/* existing data are overwritten in place */
+			length = seg->data_size - (adr - seg->adr_start);
+			if (length > size)
+				length = size;
+			dst = &seg->data[adr - seg->adr_start];
+		} else {
+			/* unused addresses up to next segment */
+			length = size;
+			next = ihex_next_segment(self, seg);
+			if ((next != NULL) && (next->adr_start - adr < size))
+				length = next->adr_start - adr;
+			dst = ihex_insert_space(self, adr, length);
+			if (dst == NULL)
+				return -1;
+		}
+
+		if (data != NULL) {
+			memcpy(dst, data, length);
+			data += length;
+		} else {
+			memset(dst, byte, length);
+		}
+		adr += length;
+		size -= length;
+	}
+
+	return 0;
+}
+
+static void ihex_remove_segment(struct ihex_object *self, struct ihex_data_segment *seg)
+{
+	assert(self != NULL);
+	assert(seg != NULL);
+
+	ihex_index_remove(self, seg);
+	self->index_hint = seg->prev;
+
+	if (seg->prev != NULL) {
+		seg->prev->next = seg->next;
+	} else {
+		self->segments = seg->next;
+	}
+	if (seg->next != NULL)
+		seg->next->prev = seg->prev;
+
+	ihex_free_segment(self, seg);
+}
+
+static int ihex_split_segment(struct ihex_object *self, struct ihex_data_segment *seg, uint32_t adr, uint32_t size)
+{
+	struct ihex_data_segment *seg_right;
+	uint32_t offset;
+
+	assert(self != NULL);
+	assert(seg != NULL);
+
+	/* right part uses the same buffer, so no data are copied */
+	offset = adr - seg->adr_start + size;
+	seg_right = ihex_alloc_segment(self);
+	if (seg_right == NULL) {
+		ihex_set_alloc_error(self);
+		return -1;
+	}
+	seg_right->adr_start = adr + size;
+	seg_right->data_size = seg->data_size - offset;
+	seg_right->data = &seg->data[offset];
+	seg_right->buffer = seg->buffer;
+	seg_right->capacity = seg->capacity;
+	seg_right->shared = (seg->shared != NULL) ? seg->shared : seg;
+	seg->shared = seg_right;
+
+	ihex_link_segment(self, seg, seg_right);
+	seg->data_size = adr - seg->adr_start;
+
+	return 0;
+}
+
+static int ihex_erase_range(struct ihex_object *self, uint32_t adr, uint32_t size)
+{
+	struct ihex_data_segment *seg;
+	struct ihex_data_segment *next;
+	uint64_t end;
+	uint64_t seg_end;
+	uint32_t length;
+
+	assert(self != NULL);
+
+	if (size == 0)
+		return 0;
+
+	if (ihex_cut_pad_spans(self, adr, size) != 0)
+		return -1;
+
+	end = (uint64_t)adr + size;
+	seg = ihex_find_segment(self, adr);
+	if ((seg == NULL) || (adr - seg->adr_start >= seg->data_size))
+		seg = ihex_next_segment(self, seg);
+
+	while ((seg != NULL) && (seg->adr_start < end)) {
+		next = seg->next;
+		seg_end = (uint64_t)seg->adr_start + seg->data_size;
+		if (seg->adr_start < adr) {
+			if (seg_end > end)
+				return ihex_split_segment(self, seg, adr, size);
+			/* tail of segment is cut off */
+			seg->data_size = adr - seg->adr_start;
+		} else if (seg_end <= end) {
+			ihex_remove_segment(self, seg);
+		} else {
+			/* head of segment is cut off, data pointer is moved only */
+			length = (uint32_t)(end - seg->adr_start);
+			seg->data += length;
+			seg->data_size -= length;
+			seg->adr_start += length;
+			self->index_hint = seg;
+			break;
+		}
+		seg = next;
+	}
+
+	return 0;
+}
+
+int ihex_write_data(struct ihex_object *self, uint32_t adr, const uint8_t *data, uint32_t size)
+{
+	uint32_t size_top;
+
+	assert(self != NULL);
+	assert(data != NULL);
+
+	size_top = ihex_range_below_top(adr, size);
+	if (ihex_write_range(self, adr, size_top, data, 0) != 0)
+		return -1;
+
+	return ihex_write_range(self, 0, size - size_top, &data[size_top], 0);
+}
+
+int ihex_fill(struct ihex_object *self, uint32_t adr, uint32_t size, uint8_t byte)
+{
+	uint32_t size_top;
+
+	assert(self != NULL);
+
+	size_top = ihex_range_below_top(adr, size);
+	if (ihex_write_range(self, adr, size_top, NULL, byte) != 0)
+		return -1;
+
+	return ihex_write_range(self, 0, size - size_top, NULL, byte);
+}
+
+int ihex_erase(struct ihex_object *self, uint32_t adr, uint32_t size)
+{
+	uint32_t size_top;
+
+	assert(self != NULL);
+
+	size_top = ihex_range_below_top(adr, size);
+	if (ihex_erase_range(self, adr, size_top) != 0)
+		return -1;
+
+	return ihex_erase_range(self, 0, size - size_top);
+}
+
+static int ihex_merge_run(struct ihex_object *self, struct ihex_data_segment *seg, struct ihex_data_segment *last)
+{
+	struct ihex_data_segment *next;
+	uint32_t size;
+	uint32_t gap;
+
+	assert(self != NULL);
+	assert(seg != NULL);
+	assert(last != NULL);
+	assert(seg != last);
+
+	/* whole run is copied into first segment, gaps are filled with pad byte, index is rebuilt by caller */
+	size = last->adr_start + last->data_size - seg->adr_start;
+	if (ihex_reserve_tail(self, seg, size - seg->data_size) != 0)
+		return -1;
+
+	do {
+		next = seg->next;
+		gap = next->adr_start - (seg->adr_start + seg->data_size);
+		memset(&seg->data[seg->data_size], self->pad_byte, gap);
+		memcpy(&seg->data[seg->data_size + gap], next->data, next->data_size);
+		seg->data_size += gap + next->data_size;
+
+		seg->next = next->next;
+		if (next->next != NULL)
+			next->next->prev = seg;
+		ihex_free_segment(self, next);
+	} while (next != last);
+
+	/* elided runs lie only in filled gaps, so they are removed without splitting */
+	return ihex_cut_pad_spans(self, seg->adr_start, seg->data_size);
+}
+
+int ihex_compact(struct ihex_object *self, uint32_t max_gap)
+{
+	struct ihex_data_segment *seg;
+	struct ihex_data_segment *last;
+	uint64_t end;
+	uint32_t head;
+
+	assert(self != NULL);
+
+	/* merged runs are replaced by their first segment in list, index is built again at the end */
+	for (seg = self->segments; seg != NULL; seg = seg->next) {
+		end = (uint64_t)seg->adr_start + seg->data_size;
+		last = seg;
+		while ((last->next != NULL) && (last->next->adr_start - end <= max_gap) &&
+		       ((uint64_t)last->next->adr_start + last->next->data_size - seg->adr_start <= 0xFFFFFFFF)) {
+			last = last->next;
+			end = (uint64_t)last->adr_start + last->data_size;
+		}
+
+		if ((last != seg) && (ihex_merge_run(self, seg, last) != 0)) {
+			/* not merged segments stay in list */
+			ihex_index_rebuild(self);
+			return -1;
+		}
+
+		/* unused end of the last arena allocation is given back */
+		if ((self->arena_block_size != 0) && (seg->shared == NULL)) {
+			head = seg->data - seg->buffer;
+			if (ihex_arena_resize(self, seg->buffer, seg->capacity, head + seg->data_size) == 0)
+				seg->capacity = head + seg->data_size;
+		}
+	}
+	ihex_index_rebuild(self);
+
+	return ihex_shrink_data(self);
+}
+
+int ihex_elide_pad(struct ihex_object *self, uint32_t min_run)
+{
+	struct ihex_data_segment *seg;
+	struct ihex_data_segment *next;
+	uint32_t run_end;
+	uint32_t end;
+	uint32_t i;
+
+	assert(self != NULL);
+	assert(min_run != 0);
+
+	/* segment is scanned from its end, erasing a run leaves data before it in place */
+	for (seg = self->segments; seg != NULL; seg = next) {
+		next = seg->next;
+		end = seg->data_size;
+		while (end > 0) {
+			i = end;
+			while ((i > 0) && (seg->data[i - 1] != self->pad_byte))
+				i--;
+			run_end = i;
+			while ((i > 0) && (seg->data[i - 1] == self->pad_byte))
+				i--;
+			if ((run_end - i >= min_run) && (ihex_erase_range(self, seg->adr_start + i, run_end - i) != 0))
+				return -1;
+			end = i;
+		}
+	}
+
+#ifndef IHEX_STATIC_POOL
+	/* arena memory is reclaimed only as a whole, split parts may keep sharing buffer */
+	if (self->arena_block_size != 0)
+		return 0;
+
+	/* parts of split segment get own buffers, the last one keeps original buffer */
+	for (seg = self->segments; seg != NULL; seg = seg->next) {
+		if ((seg->shared != NULL) && (ihex_unshare_buffer(self, seg, 0, 0) != 0))
+			return -1;
+	}
+#endif
+
+	return ihex_shrink_data(self);
+}
+
+#ifndef IHEX_STATIC_POOL
+void ihex_set_bulk_load(struct ihex_object *self, int enable)
+{
+	assert(self != NULL);
+
+	self->bulk_load = enable;
+}
+#endif
+
+static int ihex_flush_pad_run(struct ihex_object *self)
+{
+	uint8_t *dst;
+	uint32_t size;
+
+	assert(self != NULL);
+
+	size = self->pad_run_size;
+	if (size == 0)
+		return 0;
+	self->pad_run_size = 0;
+
+	if (size >= self->pad_elision)
+		return ihex_add_pad_span(self, self->pad_run_adr, size);
+
+	/* run too short for elision is stored as data */
+	if (ihex_check_data_overlapping(self, ihex_find_segment(self, self->pad_run_adr), self->pad_run_adr, size) != 0)
+		return -1;
+	dst = ihex_insert_space(self, self->pad_run_adr, size);
+	if (dst == NULL)
+		return -1;
+	memset(dst, self->pad_byte, size);
+
+	return 0;
+}
+
+static int ihex_set_data_elided(struct ihex_object *self, uint32_t adr, uint8_t *data, uint32_t size)
+{
+	uint32_t start;
+	uint32_t i;
+
+	assert(self != NULL);
+	assert(data != NULL);
+
+	/* pending pad byte run is finished by data not continuing it */
+	if ((self->pad_run_size != 0) && (adr != self->pad_run_adr + self->pad_run_size) && (ihex_flush_pad_run(self) != 0))
+		return -1;
+
+	/* pad bytes only extend pending run, so long runs never reach segment buffers */
+	i = 0;
+	while (i < size) {
+		start = i;
+		while ((i < size) && (data[i] == self->pad_byte))
+			i++;
+		if (i > start) {
+			if (self->pad_run_size == 0)
+				self->pad_run_adr = adr + start;
+			self->pad_run_size += i - start;
+		}
+		if (i == size)
+			break;
+
+		start = i;
+		while ((i < size) && (data[i] != self->pad_byte))
+			i++;
+		if (ihex_flush_pad_run(self) != 0)
+			return -1;
+		if (ihex_set_data(self, adr + start, &data[start], i - start) != 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+static uint8_t *ihex_log_reserve(struct ihex_object *self, uint32_t size)
+{
+#ifndef IHEX_STATIC_POOL
+	struct ihex_log_entry *log;
+	uint8_t *log_data;
+	size_t capacity;
+#endif
+
+	assert(self != NULL);
+
+#ifndef IHEX_STATIC_POOL
+	if (self->log_count == self->log_capacity) {
+		capacity = (self->log_capacity != 0) ? (size_t)self->log_capacity * 2 : 256;
+		/* second half of array is temporary space used by sorting */
+		log = (capacity <= UINT32_MAX) ? (struct ihex_log_entry *)realloc(self->log, capacity * 2 * sizeof(struct ihex_log_entry)) : NULL;
+		if (log == NULL) {
+			self->error = IHEX_ERROR_MALLOC;
+			return NULL;
+		}
+		self->log = log;
+		self->log_capacity = capacity;
+	}
+
+	if (self->log_data_capacity - self->log_data_size < size) {
+		capacity = (self->log_data_capacity != 0) ? self->log_data_capacity * 2 : 4096;
+		log_data = (uint8_t *)realloc(self->log_data, capacity);
+		if (log_data == NULL) {
+			self->error = IHEX_ERROR_MALLOC;
+			return NULL;
+		}
+		self->log_data = log_data;
+		self->log_data_capacity = capacity;
+	}
+#endif
+	if ((self->log_count == self->log_capacity) || (self->log_data_capacity - self->log_data_size < size)) {
+		self->error = IHEX_ERROR_POOL;
+		return NULL;
+	}
+
+	return &self->log_data[self->log_data_size];
+}
+
+static void ihex_log_commit(struct ihex_object *self, uint32_t adr, uint32_t size)
+{
+	struct ihex_log_entry *entry;
+
+	assert(self != NULL);
+	assert(self->log_count < self->log_capacity);
+
+	entry = &self->log[self->log_count++];
+	entry->adr = adr;
+	entry->size = size;
+	entry->offset = self->log_data_size;
+	self->log_data_size += size;
+}
+
+static struct ihex_log_entry *ihex_log_sort(struct ihex_object *self)
+{
+	struct ihex_log_entry *src;
+	struct ihex_log_entry *dst;
+	struct ihex_log_entry *tmp;
+	uint32_t count[256];
+	uint32_t sum;
+	uint32_t i;
+	int shift;
+
+	assert(self != NULL);
+
+	/* LSD radix sort by address, stable so records with equal address keep file order */
+	src = self->log;
+	dst = &self->log[self->log_capacity];
+	for (shift = 0; shift < 32; shift += 8) {
+		memset(count, 0, sizeof(count));
+		for (i = 0; i < self->log_count; i++)
+			count[(src[i].adr >> shift) & 0xFF]++;
+
+		/* all addresses have the same byte, pass would not change order */
+		if (count[(src[0].adr >> shift) & 0xFF] == self->log_count)
+			continue;
+
+		sum = 0;
+		for (i = 0; i < 256; i++) {
+			sum += count[i];
+			count[i] = sum - count[i];
+		}
+		for (i = 0; i < self->log_count; i++)
+			dst[count[(src[i].adr >> shift) & 0xFF]++] = src[i];
+
+		tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	return src;
+}
+
+static int ihex_log_segment(struct ihex_object *self, struct ihex_log_entry *entries, uint32_t count, uint32_t size)
+{
+	struct ihex_data_segment *seg;
+	struct ihex_data_segment *prev;
+	struct ihex_data_segment *next;
+	uint8_t *data;
+	uint32_t adr;
+	uint32_t i;
+	int s;
+
+	assert(self != NULL);
+	assert(entries != NULL);
+
+	adr = entries[0].adr;
+	prev = ihex_find_segment(self, adr);
+	if (ihex_check_data_overlapping(self, prev, adr, size) != 0)
+		return -1;
+
+	/* data joining already existing segments or scanned for pad byte runs are added record by record */
+	next = ihex_next_segment(self, prev);
+	if ((self->pad_elision != 0) || ((prev != NULL) && (prev->adr_start + prev->data_size == adr)) ||
+	    ((next != NULL) && (adr + size == next->adr_start))) {
+		for (i = 0; i < count; i++) {
+			data = &self->log_data[entries[i].offset];
+			s = (self->pad_elision != 0) ? ihex_set_data_elided(self, entries[i].adr, data, entries[i].size) :
+						       ihex_set_data(self, entries[i].adr, data, entries[i].size);
+			if (s != 0)
+				return -1;
+		}
+		return 0;
+	}
+
+	seg = ihex_create_segment(self, adr, size);
+	if (seg == NULL)
+		return -1;
+	for (i = 0; i < count; i++)
+		memcpy(&seg->data[entries[i].adr - adr], &self->log_data[entries[i].offset], entries[i].size);
+
+	ihex_link_segment(self, prev, seg);
+
+	return 0;
+}
+
+static int ihex_log_flush(struct ihex_object *self)
+{
+	struct ihex_log_entry *entries;
+	uint32_t first;
+	uint32_t i;
+	uint64_t end;
+	int s;
+
+	assert(self != NULL);
+
+	if (self->log_count == 0)
+		return 0;
+
+	entries = self->log;
+	for (i = 1; i < self->log_count; i++) {
+		if (entries[i].adr < entries[i - 1].adr) {
+			entries = ihex_log_sort(self);
+			break;
+		}
+	}
+
+	/* sorted records are swept once, each run of touching records becomes one segment */
+	s = 0;
+	i = 0;
+	while ((i < self->log_count) && (s == 0)) {
+		first = i;
+		end = (uint64_t)entries[i].adr + entries[i].size;
+		for (i++; (i < self->log_count) && (entries[i].adr <= end); i++) {
+			if (entries[i].adr < end) {
+				self->error = IHEX_ERROR_DATA_OVERLAPPING;
+				s = -1;
+				break;
+			}
+			end += entries[i].size;
+		}
+		if (s == 0)
+			s = ihex_log_segment(self, &entries[first], i - first, (uint32_t)(end - entries[first].adr));
+	}
+
+	self->log_count = 0;
+	self->log_data_size = 0;
+
+	return s;
+}
+
+static struct ihex_data_segment *ihex_get_tail(struct ihex_object *self, uint32_t adr, uint32_t size)
+{
+	struct ihex_data_segment *seg;
+	struct ihex_data_segment *next;
+
+	assert(self != NULL);
+
+	if (size == 0)
+		return NULL;
+
+	/* data scanned for pad byte runs or touching elided run take the common path */
+	if ((self->pad_elision != 0) || (ihex_pad_span_overlapping(self, adr, size) != 0))
+		return NULL;
+
+	/* only data extending segment at its end, without touching next one, can be written in place */
+	seg = ihex_find_segment(self, adr);
+	if (seg == NULL)
+		return NULL;
+	if (adr != seg->adr_start + seg->data_size)
+		return NULL;
+	next = seg->next;
+	if ((next != NULL) && (adr + size - 1 >= next->adr_start - 1))
+		return NULL;
+
+	if (ihex_reserve_tail(self, seg, size) != 0)
+		return NULL;
+	self->index_hint = seg;
+
+	return seg;
+}
+
+static int ihex_new_record(struct ihex_object *self, uint8_t size, uint16_t adr, uint8_t type, uint8_t *data)
+{
+	assert(self != NULL);
+
+	switch (type) {
+	case 0x00:
+		if (self->data_callback != NULL) {
+			if (self->data_callback(self->data_callback_ctx, (uint32_t)adr + self->extended_address, data, size) != 0)
+				self->finished_flag = 1;
+			break;
+		}
+		if (self->pad_elision != 0) {
+			if (ihex_set_data_elided(self, (uint32_t)adr + self->extended_address, data, size) != 0)
+				return -1;
+			break;
+		}
+		if (ihex_set_data(self, (uint32_t)adr + self->extended_address, data, size) != 0)
+			return -1;
+		break;
+	case 0x01:
+		self->finished_flag = 1;
+		break;
+	case 0x04:
+		if (adr != 0) {
+			self->error = IHEX_ERROR_ADDRESS_FIELD;
+			return -1;
+		}
+		self->extended_address = (uint32_t)data[0] << 24 | (uint32_t)data[1] << 16;
+		break;
+	case 0x05:
+		break;
+	default:
+		self->error = IHEX_ERROR_RECORD_TYPE;
+		return -1;
+	}
+	return 0;
+}
+
+static int ihex_parse_record(struct ihex_object *self, const char *record_line, size_t line_length)
+{
+	uint8_t buffer[255];
+	uint8_t *data;
+	uint8_t data_size;
+	uint8_t address_hi;
+	uint8_t address_lo;
+	uint16_t address;
+	uint8_t record_type;
+	uint8_t checksum;
+	uint8_t sum;
+	const char *hex;
+	char ch;
+	struct ihex_data_segment *seg;
+	int logged;
+
+	assert(self != NULL);
+	assert(record_line != NULL);
+
+	if (line_length < 12) {
+		self->error = IHEX_ERROR_LINE_LENGTH;
+		return -1;
+	}
+	if (record_line[0] != ':') {
+		self->error = IHEX_ERROR_PARSING_START_LINE;
+		return -1;
+	}
+	if ((ihex_get_hex_byte(&record_line[1], &data_size) != 0) || (ihex_get_hex_byte(&record_line[3], &address_hi) != 0) ||
+	    (ihex_get_hex_byte(&record_line[5], &address_lo) != 0) || (ihex_get_hex_byte(&record_line[7], &record_type) != 0)) {
+		self->error = IHEX_ERROR_PARSING_HEX_ENCODE;
+		return -1;
+	}
+	address = (uint16_t)address_hi << 8 | address_lo;
+
+	if (line_length - 12 < (size_t)data_size * 2) {
+		self->error = IHEX_ERROR_LINE_LENGTH;
+		return -1;
+	}
+
+	sum = data_size;
+	sum += address_hi;
+	sum += address_lo;
+	sum += record_type;
+
+	/* data extending a segment is decoded straight into its free space and committed only when valid */
+	seg = NULL;
+	data = buffer;
+	logged = 0;
+	if ((record_type == 0x00) && (self->data_callback == NULL) && (data_size > 0)) {
+		if (self->bulk_load != 0) {
+			/* bulk load mode collects data in log, they are merged at the end of parsing */
+			data = ihex_log_reserve(self, data_size);
+			if (data == NULL)
+				return -1;
+			logged = 1;
+		} else {
+			seg = ihex_get_tail(self, (uint32_t)address + self->extended_address, data_size);
+			if (seg != NULL)
+				data = &seg->data[seg->data_size];
+		}
+	}
+
+	hex = &record_line[9];
+	if (ihex_hex_decode(hex, data, data_size, &sum) != 0) {
+		self->error = IHEX_ERROR_PARSING_HEX_ENCODE;
+		return -1;
+	}
+	hex += (size_t)data_size * 2;
+
+	if (ihex_get_hex_byte(hex, &checksum) != 0) {
+		self->error = IHEX_ERROR_PARSING_HEX_ENCODE;
+		return -1;
+	}
+
+	sum += checksum;
+
+	if (sum != 0) {
+		self->error = IHEX_ERROR_CHECKSUM;
+		return -1;
+	}
+
+	ch = hex[2];
+	if ((ch != '\n') && (ch != '\r')) {
+		self->error = IHEX_ERROR_PARSING_END_LINE;
+		return -1;
+	}
+
+#ifdef IHEX_STATS
+	if (record_type < IHEX_STATS_RECORD_TYPES)
+		self->stats.records[record_type]++;
+	if (record_type == 0x00)
+		self->stats.data_bytes += data_size;
+#endif
+
+	if (seg != NULL) {
+		seg->data_size += data_size;
+		return 0;
+	}
+	if (logged != 0) {
+		ihex_log_commit(self, (uint32_t)address + self->extended_address, data_size);
+		return 0;
+	}
+
+	return ihex_new_record(self, data_size, address, record_type, data);
+}
+
+void ihex_set_data_callback(struct ihex_object *self, ihex_data_callback_t callback, void *ctx)
+{
+	assert(self != NULL);
+
+	self->data_callback = callback;
+	self->data_callback_ctx = ctx;
+}
+
+#ifndef IHEX_STATIC_POOL
+void ihex_set_pad_elision(struct ihex_object *self, uint32_t min_run)
+{
+	assert(self != NULL);
+
+	self->pad_elision = min_run;
+}
+
+void ihex_set_pad_omission(struct ihex_object *self, int enable)
+{
+	assert(self != NULL);
+
+	self->pad_omission = enable;
+}
+#endif
+
+void ihex_parse_begin(struct ihex_object *self)
+{
+	assert(self != NULL);
+
+	self->extended_address = 0;
+	self->finished_flag = 0;
+	self->line_length = 0;
+	self->log_count = 0;
+	self->log_data_size = 0;
+	self->pad_run_size = 0;
+	self->error = IHEX_NO_ERROR;
+#ifdef IHEX_STATS
+	self->stats_parse_start = ihex_stats_clock();
+#endif
+}
+
+static int ihex_parse_finish(struct ihex_object *self)
+{
+	int s;
+#ifdef IHEX_STATS
+	uint64_t start;
+#endif
+
+	assert(self != NULL);
+
+#ifdef IHEX_STATS
+	start = ihex_stats_clock();
+#endif
+	s = ihex_log_flush(self);
+	if (s == 0)
+		s = ihex_flush_pad_run(self);
+
+	if ((s == 0) && (self->finished_flag == 0)) {
+		self->error = IHEX_ERROR_NO_EOF_LINE;
+		s = -1;
+	}
+
+	if (s == 0)
+		s = ihex_shrink_data(self);
+
+#ifdef IHEX_STATS
+	self->stats.merge_ns += ihex_stats_clock() - start;
+#endif
+	IHEX_STATS_PARSE_END(self);
+
+	return s;
+}
+
+#ifdef IHEX_STATIC_POOL
+int ihex_parse_file(struct ihex_object *self, FILE *fp)
+{
+	char buf[IHEX_LINE_SIZE];
+	size_t size;
+
+	assert(self != NULL);
+	assert(fp != NULL);
+
+	/* getline allocates line buffer, file is parsed in fixed size chunks instead */
+	ihex_parse_begin(self);
+
+	while ((size = fread(buf, 1, sizeof(buf), fp)) > 0) {
+		if (ihex_parse_chunk(self, buf, size) != 0)
+			return -1;
+		if (self->finished_flag != 0)
+			break;
+	}
+
+	return ihex_parse_end(self);
+}
+#else
+int ihex_parse_file(struct ihex_object *self, FILE *fp)
+{
+	char *line = NULL;
+	size_t len = 0;
+	ssize_t size;
+
+	assert(self != NULL);
+	assert(fp != NULL);
+
+	ihex_parse_begin(self);
+
+	while ((size = getline(&line, &len, fp)) >= 0) {
+		if (ihex_parse_record(self, line, size) != 0) {
+			if (line != NULL)
+				free(line);
+			IHEX_STATS_PARSE_END(self);
+			return -1;
+		}
+		if (self->finished_flag != 0)
+			break;
+	}
+
+	if (line != NULL)
+		free(line);
+
+	return ihex_parse_finish(self);
+}
+#endif
+
+static int ihex_parse_lines(struct ihex_object *self, const char *buf, size_t len)
+{
+	const char *end;
+	const char *eol;
+	size_t length;
+
+	assert(self != NULL);
+
+	/* records are parsed in place, line ends at LF (CR before it is accepted by record parser) */
+	end = buf + len;
+	while (buf < end) {
+		eol = (const char *)memchr(buf, '\n', end - buf);
+		length = (eol != NULL) ? (size_t)(eol - buf) + 1 : (size_t)(end - buf);
+		if (ihex_parse_record(self, buf, length) != 0) {
+			/* failed parse is not finished, its time is counted here */
+			IHEX_STATS_PARSE_END(self);
+			return -1;
+		}
+		if (self->finished_flag != 0)
+			break;
+		buf += length;
+	}
+
+	return 0;
+}
+
+int ihex_parse_buffer(struct ihex_object *self, const char *buf, size_t len)
+{
+	assert(self != NULL);
+	assert((buf != NULL) || (len == 0));
+
+	ihex_parse_begin(self);
+
+	if (ihex_parse_lines(self, buf, len) != 0)
+		return -1;
+
+	return ihex_parse_finish(self);
+}
+
+int ihex_parse_chunk(struct ihex_object *self, const char *buf, size_t len)
+{
+	const char *eol;
+	size_t length;
+	size_t copy;
+	int s;
+
+	assert(self != NULL);
+	assert((buf != NULL) || (len == 0));
+
+	if (self->error != IHEX_NO_ERROR)
+		return -1;
+
+	while ((len > 0) && (self->finished_flag == 0)) {
+		eol = (const char *)memchr(buf, '\n', len);
+		length = (eol != NULL) ? (size_t)(eol - buf) + 1 : len;
+
+		/* record parser never looks past IHEX_LINE_SIZE characters, so the rest of a long line is dropped */
+		if ((eol == NULL) || (self->line_length > 0)) {
+			copy = IHEX_LINE_SIZE - self->line_length;
+			if (copy > length)
+				copy = length;
+			memcpy(&self->line[self->line_length], buf, copy);
+			self->line_length += copy;
+		}
+
+		if (eol != NULL) {
+			if (self->line_length > 0) {
+				s = ihex_parse_record(self, self->line, self->line_length);
+				self->line_length = 0;
+			} else {
+				s = ihex_parse_record(self, buf, length);
+			}
+			if (s != 0) {
+				IHEX_STATS_PARSE_END(self);
+				return -1;
+			}
+		}
+
+		buf += length;
+		len -= length;
+	}
+
+	return 0;
+}
+
+int ihex_parse_end(struct ihex_object *self)
+{
+	assert(self != NULL);
+
+	if (self->error != IHEX_NO_ERROR)
+		return -1;
+
+	/* last line without LF is parsed as is (and rejected by record parser) */
+	if ((self->finished_flag == 0) && (self->line_length > 0)) {
+		if (ihex_parse_record(self, self->line, self->line_length) != 0) {
+			IHEX_STATS_PARSE_END(self);
+			return -1;
+		}
+	}
+	self->line_length = 0;
+
+	return ihex_parse_finish(self);
+}
+
+int ihex_parse_path(struct ihex_object *self, const char *path)
+{
+#ifdef IHEX_USE_MMAP
+	struct stat st;
+	void *map;
+	int fd;
+	int s;
+
+	assert(self != NULL);
+	assert(path != NULL);
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		self->error = IHEX_ERROR_FILE;
+		return -1;
+	}
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		self->error = IHEX_ERROR_FILE;
+		return -1;
+	}
+	if (st.st_size == 0) {
+		close(fd);
+		return ihex_parse_buffer(self, NULL, 0);
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		self->error = IHEX_ERROR_FILE;
+		return -1;
+	}
+	/* access pattern is only a hint, parsing works the same if it is refused */
+	(void)posix_madvise(map, st.st_size, POSIX_MADV_SEQUENTIAL);
+
+	s = ihex_parse_buffer(self, (const char *)map, st.st_size);
+
+	munmap(map, st.st_size);
+
+	return s;
+#else
+	FILE *fp;
+	int s;
+
+	assert(self != NULL);
+	assert(path != NULL);
+
+	fp = fopen(path, "r");
+	if (fp == NULL) {
+		self->error = IHEX_ERROR_FILE;
+		return -1;
+	}
+
+	s = ihex_parse_file(self, fp);
+
+	fclose(fp);
+
+	return s;
+#endif
+}
+
+#ifdef IHEX_USE_THREADS
+struct ihex_parse_task {
+	struct ihex_object *object; /* private object with data parsed by worker */
+	const char *buf; /* chunk of text parsed by worker, starts at line beginning */
+	size_t len; /* chunk length */
+	uint32_t extended_address; /* extended address in effect at chunk start */
+	pthread_t thread; /* worker thread handle */
+	int result; /* worker parsing result */
+};
+
+static int ihex_find_extended_address(const char *buf, size_t len, uint32_t *address)
+{
+	const char *line;
+	const char *line_end;
+	uint8_t data[2];
+
+	/* walk back line by line to last type 04 record, malformed records are reported by worker owning them */
+	line_end = buf + len;
+	while (line_end > buf) {
+		line = line_end - 1;
+		while ((line > buf) && (line[-1] != '\n'))
+			line--;
+		if ((line_end - line >= 13) && (line[0] == ':') && (line[7] == '0') && (line[8] == '4') &&
+		    (ihex_get_hex_byte(&line[9], &data[0]) == 0) && (ihex_get_hex_byte(&line[11], &data[1]) == 0)) {
+			*address = (uint32_t)data[0] << 24 | (uint32_t)data[1] << 16;
+			return 1;
+		}
+		line_end = line;
+	}
+
+	return 0;
+}
+
+static void *ihex_parse_worker(void *arg)
+{
+	struct ihex_parse_task *task = (struct ihex_parse_task *)arg;
+
+	ihex_parse_begin(task->object);
+	task->object->extended_address = task->extended_address;
+	task->result = ihex_parse_lines(task->object, task->buf, task->len);
+	if (task->result == 0)
+		task->result = ihex_log_flush(task->object);
+	if (task->result == 0)
+		task->result = ihex_flush_pad_run(task->object);
+
+	return NULL;
+}
+
+#ifdef IHEX_STATS
+static void ihex_stats_merge(struct ihex_stats *stats, const struct ihex_stats *other)
+{
+	int i;
+
+	for (i = 0; i < IHEX_STATS_RECORD_TYPES; i++)
+		stats->records[i] += other->records[i];
+	stats->data_bytes += other->data_bytes;
+	stats->reallocs += other->reallocs;
+	stats->join_left_bytes += other->join_left_bytes;
+	stats->join_right_bytes += other->join_right_bytes;
+	stats->insert_between_bytes += other->insert_between_bytes;
+	stats->nodes_visited += other->nodes_visited;
+}
+#endif
+
+static int ihex_merge_segments(struct ihex_object *self, struct ihex_object *other)
+{
+	struct ihex_data_segment *seg;
+	struct ihex_data_segment *prev;
+	struct ihex_data_segment *next;
+	uint32_t i;
+	int adjacent;
+	int s;
+
+	assert(self != NULL);
+	assert(other != NULL);
+
+	/* segments are moved one by one, other object keeps only not yet moved ones in its list */
+	other->index_root = NULL;
+	other->index_count = 0;
+	other->index_hint = NULL;
+	while (other->segments != NULL) {
+		seg = other->segments;
+		other->segments = seg->next;
+
+		prev = ihex_find_segment(self, seg->adr_start);
+		if (ihex_check_data_overlapping(self, prev, seg->adr_start, seg->data_size) != 0) {
+			ihex_free_segment(other, seg);
+			return -1;
+		}
+
+		/* heap segments cannot be moved to arena object, their data are copied */
+		next = ihex_next_segment(self, prev);
+		adjacent = ((prev != NULL) && (prev->adr_start + prev->data_size == seg->adr_start)) ||
+			   ((next != NULL) && (seg->adr_start + seg->data_size == next->adr_start));
+		if ((adjacent != 0) || (self->arena_block_size != 0)) {
+			s = ihex_set_data(self, seg->adr_start, seg->data, seg->data_size);
+			ihex_free_segment(other, seg);
+			if (s != 0)
+				return -1;
+		} else {
+			ihex_link_segment(self, prev, seg);
+		}
+	}
+
+	/* elided runs of chunk are added, parts of run split at chunk boundary are joined again */
+	for (i = 0; i < other->pad_span_count; i++) {
+		if (ihex_add_pad_span(self, other->pad_spans[i].adr_start, other->pad_spans[i].size) != 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+int ihex_parse_buffer_parallel(struct ihex_object *self, const char *buf, size_t len, unsigned int threads)
+{
+	struct ihex_parse_task *tasks;
+	const char *start;
+	const char *split;
+	const char *end;
+	const char *eol;
+	unsigned int count;
+	unsigned int started;
+	unsigned int i;
+	long cpus;
+	int s;
+
+	assert(self != NULL);
+	assert((buf != NULL) || (len == 0));
+
+	if (threads == 0) {
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = (cpus > 0) ? (unsigned int)cpus : 1;
+	}
+	if (threads > len / IHEX_PARALLEL_CHUNK_MIN)
+		threads = len / IHEX_PARALLEL_CHUNK_MIN;
+
+	/* callback must see records in file order, so streaming mode is always serial */
+	if ((threads <= 1) || (self->data_callback != NULL))
+		return ihex_parse_buffer(self, buf, len);
+
+	tasks = (struct ihex_parse_task *)calloc(threads, sizeof(struct ihex_parse_task));
+	if (tasks == NULL) {
+		self->error = IHEX_ERROR_MALLOC;
+		return -1;
+	}
+
+	ihex_parse_begin(self);
+
+	/* split text at line boundaries into chunks of similar size */
+	count = 0;
+	start = buf;
+	end = buf + len;
+	for (i = 0; (i < threads) && (start < end); i++) {
+		split = buf + (len / threads) * (i + 1);
+		if ((i == threads - 1) || (split >= end)) {
+			split = end;
+		} else {
+			if (split < start)
+				split = start;
+			eol = (const char *)memchr(split, '\n', end - split);
+			split = (eol != NULL) ? eol + 1 : end;
+		}
+
+		tasks[count].buf = start;
+		tasks[count].len = split - start;
+		tasks[count].object = ihex_new();
+		if (tasks[count].object == NULL)
+			break;
+		tasks[count].object->bulk_load = self->bulk_load;
+		tasks[count].object->pad_elision = self->pad_elision;
+		count++;
+		start = split;
+	}
+
+	/* carry extended address across chunk boundaries, each chunk is scanned back only up to its last type 04 record */
+	for (i = 1; i < count; i++) {
+		if (ihex_find_extended_address(tasks[i - 1].buf, tasks[i - 1].len, &tasks[i].extended_address) == 0)
+			tasks[i].extended_address = tasks[i - 1].extended_address;
+	}
+
+	s = (start == end) ? 0 : -1;
+	started = 0;
+	while ((s == 0) && (started < count)) {
+		if (pthread_create(&tasks[started].thread, NULL, ihex_parse_worker, &tasks[started]) != 0) {
+			s = -1;
+			break;
+		}
+		started++;
+	}
+	for (i = 0; i < started; i++)
+		pthread_join(tasks[i].thread, NULL);
+
+	if (s != 0)
+		self->error = IHEX_ERROR_MALLOC;
+
+	/* merge results in file order, everything after EOF record is ignored as in serial parsing */
+	for (i = 0; (s == 0) && (i < count); i++) {
+		if (tasks[i].result != 0) {
+			self->error = tasks[i].object->error;
+			s = -1;
+			break;
+		}
+#ifdef IHEX_STATS
+		ihex_stats_merge(&self->stats, &tasks[i].object->stats);
+#endif
+		if (ihex_merge_segments(self, tasks[i].object) != 0) {
+			s = -1;
+			break;
+		}
+		if (tasks[i].object->finished_flag != 0) {
+			self->finished_flag = 1;
+			break;
+		}
+	}
+
+	for (i = 0; i < count; i++)
+		ihex_delete(tasks[i].object);
+	free(tasks);
+
+	if (s != 0) {
+		IHEX_STATS_PARSE_END(self);
 		return -1;
 	}
-	if (record_line[0] != ':') {
-		self->error = IHEX_ERROR_PARSING_START_LINE;
-		return -1;
+
+	return ihex_parse_finish(self);
+}
+#else
+int ihex_parse_buffer_parallel(struct ihex_object *self, const char *buf, size_t len, unsigned int threads)
+{
+	(void)threads;
+
+	return ihex_parse_buffer(self, buf, len);
+}
+#endif
+
+int ihex_get_data(struct ihex_object *self, uint32_t adr, uint8_t *data, uint32_t size)
+{
+	struct ihex_data_segment *seg;
+	uint64_t end;
+	uint32_t run;
+
+	assert(self != NULL);
+	assert(data != NULL);
+
+	seg = ihex_find_segment(self, adr);
+	if (seg == NULL)
+		seg = self->segments;
+
+	while (size > 0) {
+		/* skip segments lying entirely below adr */
+		while ((seg != NULL) && ((uint64_t)seg->adr_start + seg->data_size <= adr))
+			seg = seg->next;
+
+		if ((seg != NULL) && (seg->adr_start <= adr)) {
+			end = (uint64_t)seg->adr_start + seg->data_size;
+			run = (end - adr < size) ? (uint32_t)(end - adr) : size;
+			memcpy(data, seg->data + (adr - seg->adr_start), run);
+		} else {
+			/* hole up to the next segment or the top of the address space */
+			end = (seg != NULL) ? seg->adr_start : UINT64_C(0x100000000);
+			run = (end - adr < size) ? (uint32_t)(end - adr) : size;
+			memset(data, self->pad_byte, run);
+		}
+
+		data += run;
+		size -= run;
+		adr += run;
+		/* reading past 0xFFFFFFFF wraps around to the lowest segment */
+		if (adr == 0)
+			seg = self->segments;
+	}
+
+	return 0;
+}
+
+int ihex_get_view(struct ihex_object *self, uint32_t adr, uint32_t size, const uint8_t **data)
+{
+	struct ihex_data_segment *seg;
+
+	assert(self != NULL);
+	assert(data != NULL);
+
+	seg = ihex_find_segment(self, adr);
+	if (seg != NULL) {
+		if ((uint64_t)adr + size <= (uint64_t)seg->adr_start + seg->data_size) {
+			*data = seg->data + (adr - seg->adr_start);
+			return 0;
+		}
+	}
+
+	self->error = IHEX_ERROR_VIEW;
+	return -1;
+}
+
+void ihex_segment_iterator_init(const struct ihex_object *self, struct ihex_segment_iterator *iter)
+{
+	assert(self != NULL);
+	assert(iter != NULL);
+
+	iter->seg = self->segments;
+}
+
+int ihex_segment_iterator_next(struct ihex_segment_iterator *iter, uint32_t *adr, const uint8_t **data, uint32_t *size)
+{
+	const struct ihex_data_segment *seg;
+
+	assert(iter != NULL);
+
+	if (iter->seg == NULL)
+		return 0;
+
+	seg = iter->seg;
+	iter->seg = seg->next;
+	if (adr != NULL)
+		*adr = seg->adr_start;
+	if (data != NULL)
+		*data = seg->data;
+	if (size != NULL)
+		*size = seg->data_size;
+
+	return 1;
+}
+
+#ifndef IHEX_STATIC_POOL
+struct ihex_frozen *ihex_freeze(struct ihex_object *self)
+{
+	struct ihex_frozen *frozen;
+	struct ihex_frozen_range *ranges;
+	struct ihex_data_segment *seg;
+	uint32_t *starts;
+	uint8_t *data;
+	size_t ranges_offset;
+	size_t starts_offset;
+	size_t data_offset;
+	size_t data_size;
+	uint32_t i;
+
+	assert(self != NULL);
+
+	data_size = 0;
+	for (seg = self->segments; seg != NULL; seg = seg->next)
+		data_size += seg->data_size;
+
+	/* header, range table, search keys and data share one allocation */
+	ranges_offset = (sizeof(struct ihex_frozen) + IHEX_ARENA_ALIGN - 1) & ~(size_t)(IHEX_ARENA_ALIGN - 1);
+	starts_offset = ranges_offset + (size_t)self->index_count * sizeof(struct ihex_frozen_range);
+	data_offset = starts_offset + (size_t)self->index_count * sizeof(uint32_t);
+
+	frozen = (struct ihex_frozen *)malloc(data_offset + data_size);
+	if (frozen == NULL) {
+		self->error = IHEX_ERROR_MALLOC;
+		return NULL;
+	}
+	ranges = (struct ihex_frozen_range *)((uint8_t *)frozen + ranges_offset);
+	starts = (uint32_t *)((uint8_t *)frozen + starts_offset);
+	data = (uint8_t *)frozen + data_offset;
+
+	for (seg = self->segments, i = 0; seg != NULL; seg = seg->next, i++) {
+		memcpy(data, seg->data, seg->data_size);
+		starts[i] = seg->adr_start;
+		ranges[i].adr_start = seg->adr_start;
+		ranges[i].size = seg->data_size;
+		ranges[i].data = data;
+		data += seg->data_size;
 	}
-	if (ihex_get_hex_number(&record_line[1], &data_size, 1) != 0) {
-		self->error = IHEX_ERROR_PARSING_HEX_ENCODE;
-		return -1;
+
+	frozen->starts = starts;
+	frozen->ranges = ranges;
+	frozen->range_count = self->index_count;
+	frozen->data = (uint8_t *)frozen + data_offset;
+	frozen->data_size = data_size;
+	frozen->pad_byte = self->pad_byte;
+
+	return frozen;
+}
+
+void ihex_frozen_delete(struct ihex_frozen *frozen)
+{
+	free(frozen);
+}
+
+static uint32_t ihex_frozen_find(const struct ihex_frozen *frozen, uint32_t adr)
+{
+	const uint32_t *base;
+	uint32_t count;
+	uint32_t half;
+
+	if (frozen->range_count == 0)
+		return 0;
+
+	/* returns number of ranges with starting address lower or equal to adr, loop has no data dependent branches */
+	base = frozen->starts;
+	count = frozen->range_count;
+	while (count > 1) {
+		half = count / 2;
+		base = (base[half] <= adr) ? &base[half] : base;
+		count -= half;
 	}
-	if (ihex_get_hex_number(&record_line[3], (uint8_t *)&address, 2) != 0) {
-		self->error = IHEX_ERROR_PARSING_HEX_ENCODE;
-		return -1;
+
+	return (uint32_t)(base - frozen->starts) + (*base <= adr);
+}
+
+int ihex_frozen_get_data(const struct ihex_frozen *frozen, uint32_t adr, uint8_t *data, uint32_t size)
+{
+	const struct ihex_frozen_range *range;
+	uint32_t pos;
+	uint64_t end;
+	uint32_t run;
+
+	assert(frozen != NULL);
+	assert(data != NULL);
+
+	pos = ihex_frozen_find(frozen, adr);
+	if (pos > 0)
+		pos--;
+
+	while (size > 0) {
+		/* skip ranges lying entirely below adr */
+		while ((pos < frozen->range_count) && ((uint64_t)frozen->ranges[pos].adr_start + frozen->ranges[pos].size <= adr))
+			pos++;
+
+		range = (pos < frozen->range_count) ? &frozen->ranges[pos] : NULL;
+		if ((range != NULL) && (range->adr_start <= adr)) {
+			end = (uint64_t)range->adr_start + range->size;
+			run = (end - adr < size) ? (uint32_t)(end - adr) : size;
+			memcpy(data, range->data + (adr - range->adr_start), run);
+		} else {
+			/* hole up to the next range or the top of the address space */
+			end = (range != NULL) ? range->adr_start : UINT64_C(0x100000000);
+			run = (end - adr < size) ? (uint32_t)(end - adr) : size;
+			memset(data, frozen->pad_byte, run);
+		}
+
+		data += run;
+		size -= run;
+		adr += run;
+		/* reading past 0xFFFFFFFF wraps around to the lowest range */
+		if (adr == 0)
+			pos = 0;
 	}
-	if (ihex_get_hex_number(&record_line[7], &record_type, 1) != 0) {
-		self->error = IHEX_ERROR_PARSING_HEX_ENCODE;
-		return -1;
+
+	return 0;
+}
+
+int ihex_frozen_get_view(const struct ihex_frozen *frozen, uint32_t adr, uint32_t size, const uint8_t **data)
+{
+	const struct ihex_frozen_range *range;
+	uint32_t pos;
+
+	assert(frozen != NULL);
+	assert(data != NULL);
+
+	pos = ihex_frozen_find(frozen, adr);
+	if (pos > 0) {
+		range = &frozen->ranges[pos - 1];
+		if ((uint64_t)adr + size <= (uint64_t)range->adr_start + range->size) {
+			*data = range->data + (adr - range->adr_start);
+			return 0;
+		}
 	}
 
-	if (line_length - 12 < (int)data_size * 2) {
-		self->error = IHEX_ERROR_LINE_LENGTH;
+	return -1;
+}
+#endif
+
+static int ihex_writer_flush(struct ihex_writer *writer)
+{
+	assert(writer != NULL);
+
+	if ((writer->pos == 0) || (writer->fp == NULL))
+		return 0;
+	if (fwrite(writer->buf, 1, writer->pos, writer->fp) != writer->pos)
 		return -1;
+	writer->pos = 0;
+
+	return 0;
+}
+
+static size_t ihex_encode_record(char *out, uint16_t adr, uint8_t type, const uint8_t *data, uint8_t size)
+{
+	uint8_t header[4];
+	uint8_t sum;
+	uint8_t crc;
+
+	header[0] = size;
+	header[1] = (uint8_t)(adr >> 8);
+	header[2] = (uint8_t)(adr & 0x00FF);
+	header[3] = type;
+
+	sum = 0;
+	out[0] = ':';
+	ihex_hex_encode(header, &out[1], 4, &sum);
+	ihex_hex_encode(data, &out[9], size, &sum);
+	crc = 0x100 - sum;
+	ihex_hex_encode(&crc, &out[9 + (size_t)size * 2], 1, &sum);
+	out[11 + (size_t)size * 2] = '\n';
+
+	return 12 + (size_t)size * 2;
+}
+
+static int ihex_dump_record(struct ihex_writer *writer, uint16_t adr, uint8_t type, const uint8_t *data, uint8_t size)
+{
+	assert(writer != NULL);
+
+	/* writer without buffer only counts output size */
+	if (writer->buf == NULL) {
+		writer->pos += 12 + (size_t)size * 2;
+		return 0;
 	}
 
-	sum = data_size;
-	sum += (uint8_t)(address >> 8);
-	sum += (uint8_t)(address & 0x00FF);
-	sum += record_type;
+	if (writer->size - writer->pos < 12 + (size_t)size * 2) {
+		if ((writer->fp == NULL) || (ihex_writer_flush(writer) != 0))
+			return -1;
+		if (writer->size < 12 + (size_t)size * 2)
+			return -1;
+	}
 
-	index = 0;
-	data = NULL;
-	if (data_size > 0) {
-		data = (uint8_t *)malloc(data_size);
-		while (index < data_size) {
-			if (ihex_get_hex_number(&record_line[(uint16_t)9 + (uint16_t)((uint16_t)index * 2)], &data[index], 1) != 0) {
-				free(data);
-				self->error = IHEX_ERROR_PARSING_HEX_ENCODE;
-				return -1;
+	writer->pos += ihex_encode_record(&writer->buf[writer->pos], adr, type, data, size);
+
+	return 0;
+}
+
+static void ihex_cursor_init(struct ihex_object *self, struct ihex_cursor *cursor)
+{
+	assert(self != NULL);
+	assert(cursor != NULL);
+
+	cursor->object = self;
+	cursor->seg = self->segments;
+	cursor->offset = 0;
+	cursor->span = 0;
+	cursor->span_count = (self->pad_omission == 0) ? self->pad_span_count : 0;
+	cursor->span_offset = 0;
+	cursor->old_address = 0;
+	cursor->finished_flag = 0;
+}
+
+static uint32_t ihex_cursor_take(struct ihex_cursor *cursor, uint32_t adr, uint32_t max, const uint8_t **data)
+{
+	struct ihex_data_segment *seg;
+	struct ihex_pad_span *span;
+	uint32_t size;
+
+	assert(cursor != NULL);
+	assert(data != NULL);
+
+	/* next part of record data comes from current segment, or from current elided run (data set to NULL) */
+	seg = cursor->seg;
+	if ((seg != NULL) && (seg->adr_start + cursor->offset == adr)) {
+		size = seg->data_size - cursor->offset;
+		if (size > max)
+			size = max;
+		*data = &seg->data[cursor->offset];
+		cursor->offset += size;
+		if (cursor->offset == seg->data_size) {
+			cursor->seg = seg->next;
+			cursor->offset = 0;
+		}
+		return size;
+	}
+
+	if (cursor->span < cursor->span_count) {
+		span = &cursor->object->pad_spans[cursor->span];
+		if (span->adr_start + cursor->span_offset == adr) {
+			size = span->size - cursor->span_offset;
+			if (size > max)
+				size = max;
+			*data = NULL;
+			cursor->span_offset += size;
+			if (cursor->span_offset == span->size) {
+				cursor->span++;
+				cursor->span_offset = 0;
 			}
-			sum += data[index];
-			index++;
+			return size;
 		}
 	}
 
-	if (ihex_get_hex_number(&record_line[(uint16_t)9 + (uint16_t)((uint16_t)index * 2)], &checksum, 1) != 0) {
-		if (data != NULL)
-			free(data);
-		self->error = IHEX_ERROR_PARSING_HEX_ENCODE;
-		return -1;
+	return 0;
+}
+
+static int ihex_cursor_next(struct ihex_cursor *cursor, struct ihex_record *rec)
+{
+	struct ihex_data_segment *seg;
+	struct ihex_pad_span *span;
+	const uint8_t *data;
+	uint32_t new_address;
+	uint32_t rec_size;
+	uint32_t size;
+	uint32_t part;
+
+	assert(cursor != NULL);
+	assert(rec != NULL);
+
+	seg = cursor->seg;
+	span = (cursor->span < cursor->span_count) ? &cursor->object->pad_spans[cursor->span] : NULL;
+	if ((seg == NULL) && (span == NULL)) {
+		if (cursor->finished_flag != 0)
+			return 0;
+		rec->adr = 0;
+		rec->type = 0x01;
+		rec->data = NULL;
+		rec->size = 0;
+		cursor->finished_flag = 1;
+		return 1;
 	}
 
-	sum += checksum;
+	if ((span == NULL) || ((seg != NULL) && (seg->adr_start + cursor->offset < span->adr_start + cursor->span_offset))) {
+		new_address = seg->adr_start + cursor->offset;
+	} else {
+		new_address = span->adr_start + cursor->span_offset;
+	}
+	if ((new_address & 0xFFFF0000) != (cursor->old_address & 0xFFFF0000)) {
+		rec->adr_data[0] = new_address >> 24;
+		rec->adr_data[1] = (new_address >> 16) & 0xFF;
+		rec->adr = 0;
+		rec->type = 0x04;
+		rec->data = rec->adr_data;
+		rec->size = 2;
+		cursor->old_address = new_address;
+		return 1;
+	}
 
-	if ((uint8_t)(sum & 0xFF) != 0) {
-		if (data != NULL)
-			free(data);
-		self->error = IHEX_ERROR_CHECKSUM;
-		return -1;
+	rec->adr = new_address & 0xFFFF;
+	rec->type = 0x00;
+	cursor->old_address = new_address;
+
+	/* record ending inside current segment points to its data */
+	rec_size = cursor->object->align_record - new_address % cursor->object->align_record;
+	if ((seg != NULL) && (seg->adr_start + cursor->offset == new_address) && (rec_size < seg->data_size - cursor->offset)) {
+		rec->data = &seg->data[cursor->offset];
+		rec->size = rec_size;
+		cursor->offset += rec_size;
+		return 1;
 	}
 
-	ch = record_line[(uint16_t)11 + (uint16_t)((uint16_t)index * 2)];
-	if ((ch != '\n') && (ch != '\r')) {
-		if (data != NULL)
-			free(data);
-		self->error = IHEX_ERROR_PARSING_END_LINE;
-		return -1;
+	size = ihex_cursor_take(cursor, new_address, rec_size, &data);
+	if (data == NULL) {
+		memset(rec->run_data, cursor->object->pad_byte, size);
+		data = rec->run_data;
 	}
 
-	if (ihex_new_record(self, data_size, address, record_type, data) != 0) {
-		if (data != NULL)
-			free(data);
-		return -1;
+	/* record continuing into touching segment or elided run is assembled, so records are the same as without elision */
+	while ((size < rec_size) && ((part = ihex_cursor_take(cursor, new_address + size, rec_size - size, &rec->data)) != 0)) {
+		if (data != rec->run_data) {
+			memcpy(rec->run_data, data, size);
+			data = rec->run_data;
+		}
+		if (rec->data != NULL) {
+			memcpy(&rec->run_data[size], rec->data, part);
+		} else {
+			memset(&rec->run_data[size], cursor->object->pad_byte, part);
+		}
+		size += part;
 	}
 
-	if (data != NULL)
-		free(data);
-	return 0;
+	rec->data = data;
+	rec->size = size;
+
+	return 1;
 }
 
-int ihex_parse_file(struct ihex_object *self, FILE *fp)
+static int ihex_dump_records(struct ihex_object *self, struct ihex_writer *writer)
 {
-	char *line = NULL;
-	size_t len = 0;
-	int size;
+	struct ihex_cursor cursor;
+	struct ihex_record rec;
 	int s;
+#ifdef IHEX_STATS
+	uint64_t start;
+
+	start = ihex_stats_clock();
+#endif
 
 	assert(self != NULL);
-	assert(fp != NULL);
+	assert(writer != NULL);
 
-	while ((size = getline(&line, &len, fp)) >= 0) {
-		if (ihex_parse_record(self, line) != 0) {
-			if (line != NULL)
-				free(line);
-			return -1;
-		}
-		if (self->finished_flag != 0)
+	s = 0;
+	ihex_cursor_init(self, &cursor);
+	while (ihex_cursor_next(&cursor, &rec) != 0) {
+		if (ihex_dump_record(writer, rec.adr, rec.type, rec.data, rec.size) != 0) {
+			self->error = IHEX_ERROR_DUMP;
+			s = -1;
 			break;
+		}
 	}
 
-	if (self->finished_flag == 0) {
-		if (line != NULL)
-			free(line);
-		self->error = IHEX_ERROR_NO_EOF_LINE;
+#ifdef IHEX_STATS
+	self->stats.dump_ns += ihex_stats_clock() - start;
+#endif
+
+	return s;
+}
+
+int ihex_dump_file(struct ihex_object *self, FILE *fp)
+{
+	struct ihex_writer writer;
+	char buf[IHEX_DUMP_BUFFER_SIZE];
+
+	assert(self != NULL);
+	assert(fp != NULL);
+
+	writer.buf = buf;
+	writer.size = sizeof(buf);
+	writer.pos = 0;
+	writer.fp = fp;
+
+	if (ihex_dump_records(self, &writer) != 0)
 		return -1;
-	}
 
-	if (line != NULL)
-		free(line);
+	if (ihex_writer_flush(&writer) != 0) {
+		self->error = IHEX_ERROR_DUMP;
+		return -1;
+	}
 
 	return 0;
 }
 
-int ihex_get_data(struct ihex_object *self, uint32_t adr, uint8_t *data, uint32_t size)
+size_t ihex_dump_size(struct ihex_object *self)
 {
-	struct ihex_data_segment *seg;
-	int exist_flag;
+	struct ihex_writer writer;
 
 	assert(self != NULL);
-	assert(data != NULL);
 
-	if (size == 0)
-		return 0;
+	writer.buf = NULL;
+	writer.size = 0;
+	writer.pos = 0;
+	writer.fp = NULL;
 
-	seg = self->segments;
-	if (seg == NULL) {
-		memset(data, self->pad_byte, size);
+	if (ihex_dump_records(self, &writer) != 0)
 		return 0;
-	}
 
-	while (size > 0) {
-		if ((adr >= seg->adr_start) && (adr < (seg->adr_start + seg->data_size))) {
-			*data++ = seg->data[adr - seg->adr_start];
-			size--;
-			adr++;
-		} else {
-			seg = self->segments;
-			exist_flag = 0;
-			while (seg != NULL) {
-				if ((adr >= seg->adr_start) && (adr < (seg->adr_start + seg->data_size))) {
-					exist_flag = 1;
-					break;
-				}
-				seg = seg->next;
-			}
-			if (exist_flag == 0) {
-				seg = self->segments;
-				*data++ = self->pad_byte;
-				size--;
-				adr++;
-			}
-		}
-	}
+	return writer.pos;
+}
 
-	return 0;
+int ihex_dump_buffer(struct ihex_object *self, char *buf, size_t size)
+{
+	struct ihex_writer writer;
+
+	assert(self != NULL);
+	assert((buf != NULL) || (size == 0));
+
+	writer.buf = buf;
+	writer.size = size;
+	writer.pos = 0;
+	writer.fp = NULL;
+
+	return ihex_dump_records(self, &writer);
 }
 
-static int ihex_dump_record(FILE *fp, uint16_t adr, uint8_t type, uint8_t *data, uint8_t size)
+#ifdef IHEX_USE_THREADS
+struct ihex_dump_task {
+	struct ihex_cursor cursor; /* position of first record dumped by worker */
+	struct ihex_data_segment *end_seg; /* segment where worker range ends, NULL for end of data */
+	uint32_t end_offset; /* offset in end segment where worker range ends */
+	struct ihex_writer writer; /* worker output buffer */
+	pthread_t thread; /* worker thread handle */
+	int result; /* worker dumping result */
+};
+
+static uint32_t ihex_last_record_address(struct ihex_object *self, struct ihex_data_segment *seg, uint32_t end)
 {
-	uint8_t sum;
-	uint8_t crc;
-	int s;
+	uint32_t last;
+	uint32_t start;
 
-	assert(fp != NULL);
+	assert(self != NULL);
+	assert(seg != NULL);
 
-	s = fprintf(fp, ":%02X%04X%02X", size, adr, type);
-	if (s != 9)
-		return -1;
+	/* records after the first one in segment start at aligned addresses */
+	last = seg->adr_start + end - 1;
+	start = last - last % self->align_record;
+	if (start < seg->adr_start)
+		start = seg->adr_start;
 
-	sum = size;
-	sum += (uint8_t)(adr >> 8);
-	sum += (uint8_t)(adr & 0x00FF);
-	sum += type;
+	return start;
+}
 
-	while (size > 0) {
-		s = fprintf(fp, "%02X", *data);
-		if (s != 2)
+static int ihex_dump_range(struct ihex_dump_task *task)
+{
+	struct ihex_cursor cursor;
+	struct ihex_record rec;
+
+	cursor = task->cursor;
+	while ((cursor.seg != task->end_seg) || (cursor.offset != task->end_offset)) {
+		if (ihex_cursor_next(&cursor, &rec) == 0)
+			break;
+		if (ihex_dump_record(&task->writer, rec.adr, rec.type, rec.data, rec.size) != 0)
 			return -1;
-		sum += *data++;
-		size--;
 	}
 
-	crc = 0x100 - sum;
-	s = fprintf(fp, "%02X\n", crc);
-	if (s != 3)
-		return -1;
-
 	return 0;
 }
 
-static int ihex_dump_segment(struct ihex_object *self, struct ihex_data_segment *seg, FILE *fp, uint32_t *old_address)
+static void *ihex_dump_worker(void *arg)
 {
-	uint32_t new_address;
-	uint32_t total;
-	uint32_t remained;
-	uint32_t max_rec_size;
-	uint32_t rec_size;
-	uint8_t adr_data[2];
+	struct ihex_dump_task *task = (struct ihex_dump_task *)arg;
+	size_t size;
+
+	/* count first, so output buffer is allocated once with exact size */
+	task->writer.buf = NULL;
+	task->writer.pos = 0;
+	task->writer.fp = NULL;
+	ihex_dump_range(task);
+	size = task->writer.pos;
+
+	task->writer.buf = (char *)malloc(size > 0 ? size : 1);
+	task->writer.size = size;
+	task->writer.pos = 0;
+	if (task->writer.buf == NULL) {
+		task->result = -1;
+		return NULL;
+	}
+	task->result = ihex_dump_range(task);
 
-	assert(seg != NULL);
+	return NULL;
+}
+
+int ihex_dump_file_parallel(struct ihex_object *self, FILE *fp, unsigned int threads)
+{
+	struct ihex_dump_task *tasks;
+	struct ihex_data_segment *seg;
+	struct ihex_writer writer;
+	uint64_t total;
+	uint64_t target;
+	uint64_t done;
+	uint32_t offset;
+	uint32_t adr;
+	unsigned int count;
+	unsigned int started;
+	unsigned int i;
+	long cpus;
+	char eof[12];
+	int s;
+#ifdef IHEX_STATS
+	uint64_t start;
+#endif
+
+	assert(self != NULL);
 	assert(fp != NULL);
-	assert(old_address != NULL);
+
+	if (threads == 0) {
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = (cpus > 0) ? (unsigned int)cpus : 1;
+	}
 
 	total = 0;
-	while (total < seg->data_size) {
-		new_address = seg->adr_start + total;
-		max_rec_size = self->align_record - new_address % self->align_record;
-		rec_size = max_rec_size;
-		remained = seg->data_size - total;
-		if (rec_size > remained)
-			rec_size = remained;
-
-		if ((new_address & 0xFFFF0000) != (*old_address & 0xFFFF0000)) {
-			adr_data[0] = new_address >> 24;
-			adr_data[1] = (new_address >> 16) & 0xFF;
-			if (ihex_dump_record(fp, 0, 0x04, adr_data, 2) != 0) {
-				self->error = IHEX_ERROR_DUMP;
-				return -1;
-			}
+	for (seg = self->segments; seg != NULL; seg = seg->next)
+		total += seg->data_size;
+	if (threads > total / IHEX_PARALLEL_DUMP_MIN)
+		threads = total / IHEX_PARALLEL_DUMP_MIN;
+
+	/* ranges are split by segment data only, so dumped elided runs need serial dump */
+	if ((threads <= 1) || ((self->pad_span_count != 0) && (self->pad_omission == 0)))
+		return ihex_dump_file(self, fp);
+
+	tasks = (struct ihex_dump_task *)calloc(threads, sizeof(struct ihex_dump_task));
+	if (tasks == NULL) {
+		self->error = IHEX_ERROR_MALLOC;
+		return -1;
+	}
+#ifdef IHEX_STATS
+	start = ihex_stats_clock();
+#endif
+
+	/* split data into ranges of similar size, every range starts at record boundary */
+	count = 0;
+	done = 0;
+	seg = self->segments;
+	ihex_cursor_init(self, &tasks[0].cursor);
+	for (i = 1; i < threads; i++) {
+		target = total * i / threads;
+		while ((seg != NULL) && (done + seg->data_size <= target)) {
+			done += seg->data_size;
+			seg = seg->next;
 		}
+		if (seg == NULL)
+			break;
 
-		if (ihex_dump_record(fp, new_address & 0xFFFF, 0x00, &seg->data[total], rec_size) != 0) {
-			self->error = IHEX_ERROR_DUMP;
-			return -1;
+		adr = seg->adr_start + (uint32_t)(target - done);
+		adr += (self->align_record - adr % self->align_record) % self->align_record;
+		offset = adr - seg->adr_start;
+		if (offset >= seg->data_size)
+			continue;
+		if ((seg == tasks[count].cursor.seg) && (offset <= tasks[count].cursor.offset))
+			continue;
+
+		tasks[count].end_seg = seg;
+		tasks[count].end_offset = offset;
+		count++;
+
+		tasks[count].cursor = tasks[0].cursor;
+		tasks[count].cursor.seg = seg;
+		tasks[count].cursor.offset = offset;
+		if (offset > 0) {
+			tasks[count].cursor.old_address = ihex_last_record_address(self, seg, offset);
+		} else {
+			tasks[count].cursor.old_address = (seg->prev != NULL) ? ihex_last_record_address(self, seg->prev, seg->prev->data_size) : 0;
+		}
+	}
+	tasks[count].end_seg = NULL;
+	tasks[count].end_offset = 0;
+	count++;
+
+	s = 0;
+	started = 0;
+	while (started < count) {
+		if (pthread_create(&tasks[started].thread, NULL, ihex_dump_worker, &tasks[started]) != 0) {
+			self->error = IHEX_ERROR_MALLOC;
+			s = -1;
+			break;
+		}
+		started++;
+	}
+	for (i = 0; i < started; i++) {
+		pthread_join(tasks[i].thread, NULL);
+		if ((s == 0) && (tasks[i].result != 0)) {
+			self->error = IHEX_ERROR_MALLOC;
+			s = -1;
 		}
+	}
 
-		*old_address = new_address;
-		total += rec_size;
+	/* ranges are concatenated in address order, followed by EOF record */
+	for (i = 0; (s == 0) && (i < count); i++) {
+		tasks[i].writer.fp = fp;
+		if (ihex_writer_flush(&tasks[i].writer) != 0) {
+			self->error = IHEX_ERROR_DUMP;
+			s = -1;
+		}
+	}
+	if (s == 0) {
+		writer.buf = eof;
+		writer.size = sizeof(eof);
+		writer.pos = 0;
+		writer.fp = fp;
+		if ((ihex_dump_record(&writer, 0, 0x01, NULL, 0) != 0) || (ihex_writer_flush(&writer) != 0)) {
+			self->error = IHEX_ERROR_DUMP;
+			s = -1;
+		}
 	}
 
-	return 0;
+	for (i = 0; i < count; i++)
+		free(tasks[i].writer.buf);
+	free(tasks);
+
+#ifdef IHEX_STATS
+	self->stats.dump_ns += ihex_stats_clock() - start;
+#endif
+
+	return s;
 }
+#else
+int ihex_dump_file_parallel(struct ihex_object *self, FILE *fp, unsigned int threads)
+{
+	(void)threads;
 
-int ihex_dump_file(struct ihex_object *self, FILE *fp)
+	return ihex_dump_file(self, fp);
+}
+#endif
+
+#ifndef IHEX_STATIC_POOL
+struct ihex_encoder *ihex_encoder_new(struct ihex_object *self)
 {
-	struct ihex_data_segment *seg;
-	uint32_t old_address;
+	struct ihex_encoder *enc;
 
 	assert(self != NULL);
-	assert(fp != NULL);
 
-	old_address = 0;
-	seg = self->segments;
-	while (seg != NULL) {
-		if (ihex_dump_segment(self, seg, fp, &old_address) != 0)
-			return -1;
-		seg = seg->next;
+	enc = (struct ihex_encoder *)malloc(sizeof(struct ihex_encoder));
+	if (enc == NULL) {
+		self->error = IHEX_ERROR_MALLOC;
+		return NULL;
 	}
 
-	if (ihex_dump_record(fp, 0, 0x01, NULL, 0) != 0) {
-		self->error = IHEX_ERROR_DUMP;
-		return -1;
+	ihex_cursor_init(self, &enc->cursor);
+	enc->record_length = 0;
+	enc->record_pos = 0;
+
+	return enc;
+}
+
+void ihex_encoder_delete(struct ihex_encoder *enc)
+{
+	free(enc);
+}
+
+size_t ihex_encoder_read(struct ihex_encoder *enc, char *buf, size_t cap)
+{
+	struct ihex_record rec;
+	size_t total;
+	size_t length;
+
+	assert(enc != NULL);
+	assert((buf != NULL) || (cap == 0));
+
+	total = 0;
+	while (total < cap) {
+		if (enc->record_pos < enc->record_length) {
+			length = enc->record_length - enc->record_pos;
+			if (length > cap - total)
+				length = cap - total;
+			memcpy(&buf[total], &enc->record[enc->record_pos], length);
+			enc->record_pos += length;
+			total += length;
+			continue;
+		}
+
+		if (ihex_cursor_next(&enc->cursor, &rec) == 0)
+			break;
+
+		/* records fitting in caller buffer are encoded in place, others are kept for next reads */
+		length = 12 + (size_t)rec.size * 2;
+		if (length <= cap - total) {
+			total += ihex_encode_record(&buf[total], rec.adr, rec.type, rec.data, rec.size);
+		} else {
+			enc->record_length = ihex_encode_record(enc->record, rec.adr, rec.type, rec.data, rec.size);
+			enc->record_pos = 0;
+		}
 	}
 
-	return 0;
-}
\ No newline at end of file
+	return total;
+}
+#endif
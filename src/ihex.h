@@ -26,8 +26,13 @@ SOFTWARE.
 #define __IHEX_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdio.h>
 
+#include "ihex_config.h"
+
+#define IHEX_LINE_SIZE 524 /* maximum number of record line characters examined by parser */
+
 /**
  * Enum type with defined errors.
  */
@@ -43,34 +48,157 @@ enum ihex_error {
 	IHEX_ERROR_CHECKSUM,
 	IHEX_ERROR_RECORD_TYPE,
 	IHEX_ERROR_MALLOC,
-	IHEX_ERROR_DUMP
+	IHEX_ERROR_DUMP,
+	IHEX_ERROR_FILE,
+	IHEX_ERROR_VIEW,
+	IHEX_ERROR_POOL
 };
 
 typedef enum ihex_error ihex_error_e; /* typedef with error type */
 
+/**
+ * Data record callback type, used in streaming parse mode.
+ * 
+ * @param ctx user context pointer
+ * @param adr absolute address of record data (extended address included)
+ * @param data pointer to record data
+ * @param size size of record data
+ * @return 0 to continue parsing, else to stop parsing without error
+ */
+typedef int (*ihex_data_callback_t)(void *ctx, uint32_t adr, const uint8_t *data, uint8_t size);
+
 /**
  * Structure with data segment fields.
  */
 struct ihex_data_segment {
 	uint32_t adr_start; /* starting address of data segment */
 	uint32_t data_size; /* continous data segment size */
-	uint8_t *data; /* pointer to data (dynamically created) */
+	uint8_t *data; /* pointer to data (inside of buffer) */
+	uint8_t *buffer; /* pointer to dynamically created buffer with free space before and after data */
+	uint32_t capacity; /* allocated buffer size (grows geometrically) */
+	struct ihex_data_segment *shared; /* next segment sharing the same buffer after split (circular list), NULL if buffer is not shared */
 	struct ihex_data_segment *prev; /* pointer to previous data segment (two-dir list) */
 	struct ihex_data_segment *next; /* pointer to next data segment (two-dir list) */
-} ihex_data_segment;
+	struct ihex_data_segment *parent; /* parent node in segments index tree, NULL for root */
+	struct ihex_data_segment *left; /* left child in segments index tree (lower addresses) */
+	struct ihex_data_segment *right; /* right child in segments index tree (higher addresses) */
+	int height; /* height of subtree in segments index tree (leaf has 1) */
+};
+
+/**
+ * Structure with run of pad bytes elided from parsed data, stored without its bytes.
+ */
+struct ihex_pad_span {
+	uint32_t adr_start; /* starting address of elided run */
+	uint32_t size; /* elided run size */
+};
+
+/**
+ * Structure with one entry of data vector (scatter-gather write).
+ */
+struct ihex_data_vec {
+	uint32_t adr; /* start address where data should be placed */
+	const uint8_t *data; /* pointer to data */
+	uint32_t size; /* size of data */
+};
+
+struct ihex_encoder; /* pull encoder, internal structure */
+struct ihex_arena_block; /* arena memory block, internal structure */
+struct ihex_log_entry; /* data record collected in bulk load mode, internal structure */
+
+/**
+ * Structure with segment iterator state. Fields are internal, use ihex_segment_iterator_* methods.
+ */
+struct ihex_segment_iterator {
+	const struct ihex_data_segment *seg; /* next data segment, NULL when iteration ended */
+};
+
+/**
+ * Structure with one data range of frozen image.
+ */
+struct ihex_frozen_range {
+	uint32_t adr_start; /* starting address of data range */
+	uint32_t size; /* data range size */
+	const uint8_t *data; /* pointer to range data (inside of frozen image data) */
+};
+
+/**
+ * Structure with read-only image created by ihex_freeze, all fields and data live in one memory block.
+ */
+struct ihex_frozen {
+	const uint32_t *starts; /* sorted starting addresses of ranges, searched separately from range table */
+	const struct ihex_frozen_range *ranges; /* ranges in ascending address order */
+	uint32_t range_count; /* number of ranges */
+	const uint8_t *data; /* data of all ranges stored contiguously in address order */
+	size_t data_size; /* total size of data */
+	uint8_t pad_byte; /* pad byte value, used to fill unassigned addresses */
+};
+
+#ifdef IHEX_STATS
+#define IHEX_STATS_RECORD_TYPES 6 /* number of known record types (0x00 - 0x05) */
+
+/**
+ * Structure with performance counters, collected only when library is built with IHEX_STATS.
+ */
+struct ihex_stats {
+	uint64_t records[IHEX_STATS_RECORD_TYPES]; /* number of parsed records, indexed by record type */
+	uint64_t data_bytes; /* number of data bytes in parsed data records */
+	uint32_t segments; /* current number of data segments */
+	uint64_t reallocs; /* number of data buffer grows (realloc or move to new buffer) */
+	uint64_t join_left_bytes; /* bytes copied when data extend segment at its end */
+	uint64_t join_right_bytes; /* bytes copied when data extend segment at its start (including move to new buffer) */
+	uint64_t insert_between_bytes; /* bytes copied when data join two segments (including data of right segment) */
+	uint64_t nodes_visited; /* index tree nodes examined when looking for data position and overlapping */
+	uint64_t parse_ns; /* wall time of parsing in nanoseconds, from parse begin to end of parsing */
+	uint64_t merge_ns; /* wall time of bulk load merge and buffer shrinking at end of parsing (part of parse_ns) */
+	uint64_t dump_ns; /* wall time of dumping in nanoseconds */
+};
+#endif
 
 /**
  * Structure with object internal data fields.
  */
 struct ihex_object {
 	struct ihex_data_segment *segments; /* pointer to data segments list */
+	struct ihex_data_segment *index_root; /* root of AVL tree linked through segments (O(log n) lookup, insert and remove, no extra memory) */
+	uint32_t index_count; /* number of data segments in index */
+	struct ihex_data_segment *index_hint; /* last touched data segment (O(1) lookup for sequential input), NULL if none */
+	struct ihex_arena_block *arena; /* list of arena memory blocks, NULL if heap allocation is used */
+	struct ihex_arena_block *arena_current; /* arena block used for next allocations */
+	size_t arena_block_size; /* minimal size of newly allocated arena block, 0 if heap allocation is used */
+	struct ihex_data_segment *free_segments; /* released segment descriptors ready for reuse (arena mode) */
+	struct ihex_data_segment *segment_pool; /* caller provided segment descriptors, NULL if not static pool mode */
+	uint32_t segment_pool_count; /* number of segment descriptors in static pool */
 	uint8_t pad_byte; /* pad byte value, used to fill unassigned addresses */
 	uint8_t align_record; /* align width in bytes, used in data dumping to ihex file */
+	uint32_t pad_elision; /* minimal length of pad byte run elided from parsed data, 0 if disabled */
+	int pad_omission; /* flag used to leave elided pad byte runs out of dump */
+	struct ihex_pad_span *pad_spans; /* array of elided pad byte runs sorted by address */
+	uint32_t pad_span_count; /* number of elided pad byte runs */
+	uint32_t pad_span_capacity; /* allocated size of elided pad byte runs array */
+	uint32_t pad_run_adr; /* starting address of parsed pad byte run not yet elided or stored as data */
+	uint32_t pad_run_size; /* size of parsed pad byte run not yet elided or stored as data, 0 if none */
 	uint32_t extended_address; /* temporary field with extended address used in data parsing */
 	int finished_flag; /* flag used to indicate EOF line in ihex file */
+	ihex_data_callback_t data_callback; /* data record callback, if set data are passed to it instead of segments */
+	void *data_callback_ctx; /* user context pointer passed to data record callback */
+	int bulk_load; /* flag used to enable bulk load mode (data records merged once at the end of parsing) */
+	struct ihex_log_entry *log; /* array of data records collected in bulk load mode (and space for sorting) */
+	uint32_t log_count; /* number of collected data records */
+	uint32_t log_capacity; /* allocated number of data records */
+	uint8_t *log_data; /* buffer with data of collected data records */
+	size_t log_data_size; /* size of collected data */
+	size_t log_data_capacity; /* allocated size of buffer with collected data */
+	char line[IHEX_LINE_SIZE]; /* partial record line carried between parsed chunks */
+	uint32_t line_length; /* number of characters in partial record line */
 	ihex_error_e error; /* field with error code during operating */
+#ifdef IHEX_STATS
+	struct ihex_stats stats; /* performance counters */
+	uint64_t stats_parse_start; /* time of parse begin, used to measure parse wall time */
+#endif
 };
 
+#ifndef IHEX_STATIC_POOL
 /**
  * Create and return pointer to created object instance.
  * 
@@ -78,12 +206,66 @@ struct ihex_object {
  */
 struct ihex_object *ihex_new(void);
 
+/**
+ * Create object instance with arena allocation.
+ * Segment descriptors and data are allocated from arena memory blocks, which are kept
+ * by ihex_reset, so repeated parsing of similar files does no allocator calls.
+ * 
+ * @param block_size minimal size of arena memory block in bytes
+ * @return pointer to object instance
+ */
+struct ihex_object *ihex_new_arena(size_t block_size);
+#endif
+
+/**
+ * Initialize object instance in caller provided memory with static pool allocation.
+ * Segment descriptors are taken from segments array and data are allocated from data buffer,
+ * no dynamic memory is used. Pool exhaustion is reported by IHEX_ERROR_POOL error.
+ * Object must not be passed to ihex_delete, ihex_reset releases all pool memory.
+ * 
+ * @param self pointer to object instance memory
+ * @param segments pointer to array of segment descriptors
+ * @param segment_count number of segment descriptors (maximum number of segments)
+ * @param data pointer to buffer for segments data
+ * @param data_size size of buffer for segments data, must be bigger than arena block header
+ *                  (about 32 bytes plus alignment of data pointer)
+ * @return 0 if no error, else if error (IHEX_ERROR_POOL if data buffer is too small)
+ */
+int ihex_init_static(struct ihex_object *self, struct ihex_data_segment *segments, uint32_t segment_count, uint8_t *data, size_t data_size);
+
+/**
+ * Remove all data segments and reset parser state, allocated memory is kept for reuse.
+ * Pad byte, record alignment and data callback settings are preserved.
+ * 
+ * @param self pointer to object instance
+ */
+void ihex_reset(struct ihex_object *self);
+
+#ifndef IHEX_STATIC_POOL
 /**
  * Delete object instance and all internal references to data memory segments.
  * 
  * @param self pointer to object instance
  */
 void ihex_delete(struct ihex_object *self);
+#endif
+
+#ifdef IHEX_STATS
+/**
+ * Get performance counters collected since object creation or last ihex_clear_stats call.
+ * 
+ * @param self pointer to object instance
+ * @param stats pointer to structure where counters are copied
+ */
+void ihex_get_stats(struct ihex_object *self, struct ihex_stats *stats);
+
+/**
+ * Reset all performance counters to zero.
+ * 
+ * @param self pointer to object instance
+ */
+void ihex_clear_stats(struct ihex_object *self);
+#endif
 
 /**
  * Method to get error description if any.
@@ -103,6 +285,115 @@ const char *ihex_get_error_string(struct ihex_object *self);
  */
 int ihex_parse_file(struct ihex_object *self, FILE *fp);
 
+/**
+ * Method to parse intelhex data from memory buffer.
+ * Records are parsed in place, without copying lines. LF and CRLF line endings are accepted.
+ * 
+ * @param self pointer to object instance
+ * @param buf pointer to buffer with intelhex text
+ * @param len length of buffer in bytes
+ * @return 0 if no error, else if error
+ */
+int ihex_parse_buffer(struct ihex_object *self, const char *buf, size_t len);
+
+/**
+ * Method to parse intelhex data from memory buffer using worker threads.
+ * Text is split at line boundaries into chunks parsed concurrently, then results are merged
+ * with the same data overlapping detection as in serial parsing.
+ * Falls back to serial parsing for small buffers, in streaming mode or when built without threads.
+ * 
+ * @param self pointer to object instance
+ * @param buf pointer to buffer with intelhex text
+ * @param len length of buffer in bytes
+ * @param threads number of worker threads, 0 to use all online cpus
+ * @return 0 if no error, else if error
+ */
+int ihex_parse_buffer_parallel(struct ihex_object *self, const char *buf, size_t len, unsigned int threads);
+
+/**
+ * Method to set data record callback (streaming parse mode).
+ * When set, every parsed data record is passed to callback and no data segments are created,
+ * so memory usage does not depend on image size. Set NULL callback to restore normal mode.
+ * 
+ * @param self pointer to object instance
+ * @param callback pointer to callback function or NULL
+ * @param ctx user context pointer passed to callback
+ */
+void ihex_set_data_callback(struct ihex_object *self, ihex_data_callback_t callback, void *ctx);
+
+#ifndef IHEX_STATIC_POOL
+/**
+ * Method to enable or disable pad byte run elision.
+ * Parsed data records are scanned before they are stored, runs of pad byte at least min_run bytes long
+ * (also across records) are kept only as address ranges, so their bytes take no memory.
+ * Elided runs are assigned addresses: data overlapping them are reported as overlapping, reading them
+ * returns pad byte and they are dumped unless ihex_set_pad_omission is enabled.
+ * Segment iterator, data views and frozen images see them as unassigned addresses.
+ * Not available in streaming parse mode, where no data are stored.
+ * 
+ * @param self pointer to object instance
+ * @param min_run minimal length of elided run, 0 to disable elision
+ */
+void ihex_set_pad_elision(struct ihex_object *self, uint32_t min_run);
+
+/**
+ * Method to enable or disable omission of elided pad byte runs from dump.
+ * 
+ * @param self pointer to object instance
+ * @param enable 0 to dump elided runs as data records (default), else to leave them out
+ */
+void ihex_set_pad_omission(struct ihex_object *self, int enable);
+#endif
+
+#ifndef IHEX_STATIC_POOL
+/**
+ * Method to enable or disable bulk load mode.
+ * In bulk load mode parsed data records are only collected and merged into data segments at the end
+ * of parsing (sorted once by address, each segment allocated once), which is much faster for files with
+ * records in random order. Collected records use heap memory.
+ * 
+ * @param self pointer to object instance
+ * @param enable 0 to disable, else to enable bulk load mode
+ */
+void ihex_set_bulk_load(struct ihex_object *self, int enable);
+#endif
+
+/**
+ * Method to start incremental parsing of intelhex data delivered in chunks.
+ * 
+ * @param self pointer to object instance
+ */
+void ihex_parse_begin(struct ihex_object *self);
+
+/**
+ * Method to parse next chunk of intelhex data.
+ * Chunks may be split at any character, partial record lines are carried to next call.
+ * 
+ * @param self pointer to object instance
+ * @param buf pointer to chunk with intelhex text
+ * @param len length of chunk in bytes
+ * @return 0 if no error, else if error
+ */
+int ihex_parse_chunk(struct ihex_object *self, const char *buf, size_t len);
+
+/**
+ * Method to finish incremental parsing.
+ * 
+ * @param self pointer to object instance
+ * @return 0 if no error, else if error (e.g. no EOF line received)
+ */
+int ihex_parse_end(struct ihex_object *self);
+
+/**
+ * Method to parse intelhex file by its path.
+ * File is memory mapped (where supported) and parsed in place.
+ * 
+ * @param self pointer to object instance
+ * @param path path to intelhex file
+ * @return 0 if no error, else if error
+ */
+int ihex_parse_path(struct ihex_object *self, const char *path);
+
 /**
  * Main method to dump intelhex file.
  * 
@@ -112,6 +403,66 @@ int ihex_parse_file(struct ihex_object *self, FILE *fp);
  */
 int ihex_dump_file(struct ihex_object *self, FILE *fp);
 
+/**
+ * Method to dump intelhex file using worker threads.
+ * Data are split into ranges of similar size encoded concurrently, output is the same as in ihex_dump_file.
+ * Falls back to serial dumping for small images or when built without threads.
+ * 
+ * @param self pointer to object instance
+ * @param fp pointer to file stream handler (write mode)
+ * @param threads number of worker threads, 0 to use all online cpus
+ * @return 0 if no error, else if error
+ */
+int ihex_dump_file_parallel(struct ihex_object *self, FILE *fp, unsigned int threads);
+
+/**
+ * Method to compute exact length of intelhex dump, without encoding any record.
+ * 
+ * @param self pointer to object instance
+ * @return number of characters written by ihex_dump_file or ihex_dump_buffer
+ */
+size_t ihex_dump_size(struct ihex_object *self);
+
+/**
+ * Method to dump intelhex file into memory buffer.
+ * Output is not null terminated, its length is equal to ihex_dump_size.
+ * 
+ * @param self pointer to object instance
+ * @param buf pointer to output buffer
+ * @param size size of output buffer (at least ihex_dump_size)
+ * @return 0 if no error, else if error (e.g. buffer too small)
+ */
+int ihex_dump_buffer(struct ihex_object *self, char *buf, size_t size);
+
+#ifndef IHEX_STATIC_POOL
+/**
+ * Create pull encoder producing intelhex text of object on demand.
+ * Object data must not be modified while encoder is in use.
+ * 
+ * @param self pointer to object instance
+ * @return pointer to encoder instance, NULL if memory allocation error
+ */
+struct ihex_encoder *ihex_encoder_new(struct ihex_object *self);
+
+/**
+ * Delete pull encoder instance.
+ * 
+ * @param enc pointer to encoder instance
+ */
+void ihex_encoder_delete(struct ihex_encoder *enc);
+
+/**
+ * Read next part of intelhex text from pull encoder.
+ * Records may be split between reads, output is the same as in ihex_dump_file.
+ * 
+ * @param enc pointer to encoder instance
+ * @param buf pointer to output buffer
+ * @param cap size of output buffer
+ * @return number of characters written to buffer, 0 when whole text was read
+ */
+size_t ihex_encoder_read(struct ihex_encoder *enc, char *buf, size_t cap);
+#endif
+
 /**
  * Method used to add binary data to segments.
  * Auto check for data overlaping.
@@ -124,6 +475,75 @@ int ihex_dump_file(struct ihex_object *self, FILE *fp);
  */
 int ihex_set_data(struct ihex_object *self, uint32_t adr, uint8_t *data, uint32_t size);
 
+/**
+ * Method used to write binary data, existing data are overwritten in place.
+ * Unused addresses in range are added to segments as by ihex_set_data.
+ * 
+ * @param self pointer to object instance
+ * @param adr start address where data should be written
+ * @param data pointer to data
+ * @param size size of data to write
+ * @return 0 if no error, else if error
+ */
+int ihex_write_data(struct ihex_object *self, uint32_t adr, const uint8_t *data, uint32_t size);
+
+/**
+ * Method used to fill address range with byte value, existing data are overwritten in place.
+ * 
+ * @param self pointer to object instance
+ * @param adr start address of range
+ * @param size size of range
+ * @param byte fill value
+ * @return 0 if no error, else if error
+ */
+int ihex_fill(struct ihex_object *self, uint32_t adr, uint32_t size, uint8_t byte);
+
+/**
+ * Method used to remove data in address range.
+ * Segment split by erased range keeps its buffer shared by both parts, untouched data are not copied.
+ * 
+ * @param self pointer to object instance
+ * @param adr start address of range
+ * @param size size of range
+ * @return 0 if no error, else if error
+ */
+int ihex_erase(struct ihex_object *self, uint32_t adr, uint32_t size);
+
+/**
+ * Merge data segments separated by gaps not bigger than max_gap and shrink buffers to fit.
+ * Gaps are filled with pad byte, so dumped records are fuller and lookups visit fewer segments.
+ * Elided pad byte runs count as gaps, merged segment stores them as data.
+ * 
+ * @param self pointer to object instance
+ * @param max_gap maximum size of gap between merged segments (0 keeps data unchanged, only shrinks buffers)
+ * @return 0 if no error, else if error
+ */
+int ihex_compact(struct ihex_object *self, uint32_t max_gap);
+
+/**
+ * Remove runs of pad byte at least min_run bytes long from data segments (reverse of ihex_compact).
+ * Segments are split at removed runs and their data are moved to buffers of exact size.
+ * Removed addresses become unassigned (unlike runs elided during parsing, see ihex_set_pad_elision),
+ * so they are not dumped and new data can be set there without overlapping error.
+ * 
+ * @param self pointer to object instance
+ * @param min_run minimal length of removed run (must not be 0)
+ * @return 0 if no error, else if error
+ */
+int ihex_elide_pad(struct ihex_object *self, uint32_t min_run);
+
+/**
+ * Method used to add many binary data blocks at once.
+ * Blocks are sorted by address and every touched data segment is resized only once.
+ * Result is the same as calling ihex_set_data for each vector entry in order, stopping on first error.
+ * 
+ * @param self pointer to object instance
+ * @param vec pointer to array of data vector entries
+ * @param count number of data vector entries
+ * @return 0 if no error, else if error
+ */
+int ihex_set_data_vec(struct ihex_object *self, const struct ihex_data_vec *vec, uint32_t count);
+
 /**
  * Method used to get binary data from segments.
  * Auto fill unused addresses.
@@ -136,4 +556,77 @@ int ihex_set_data(struct ihex_object *self, uint32_t adr, uint8_t *data, uint32_
  */
 int ihex_get_data(struct ihex_object *self, uint32_t adr, uint8_t *data, uint32_t size);
 
+/**
+ * Method to get direct pointer to data stored inside of one data segment (zero copy).
+ * Pointer is valid until object data are modified or object is deleted.
+ * 
+ * @param self pointer to object instance
+ * @param adr start address of requested data
+ * @param size size of requested data
+ * @param data pointer to place where data pointer should be write
+ * @return 0 if no error, else if error (range is not completely inside of one data segment)
+ */
+int ihex_get_view(struct ihex_object *self, uint32_t adr, uint32_t size, const uint8_t **data);
+
+/**
+ * Initialize iterator over data segments in ascending address order.
+ * 
+ * @param self pointer to object instance
+ * @param iter pointer to iterator instance
+ */
+void ihex_segment_iterator_init(const struct ihex_object *self, struct ihex_segment_iterator *iter);
+
+/**
+ * Get next data segment without copying its data.
+ * Data pointer is valid until object data are modified or object is deleted.
+ * 
+ * @param iter pointer to iterator instance
+ * @param adr pointer to place where segment starting address should be write
+ * @param data pointer to place where segment data pointer should be write
+ * @param size pointer to place where segment data size should be write
+ * @return 1 if segment was returned, 0 if there are no more segments
+ */
+int ihex_segment_iterator_next(struct ihex_segment_iterator *iter, uint32_t *adr, const uint8_t **data, uint32_t *size);
+
+#ifndef IHEX_STATIC_POOL
+/**
+ * Create compact read-only copy of object data: one data block and flat sorted range table.
+ * Frozen image is independent of object and never modified, so any number of threads
+ * can read it concurrently without locking.
+ * 
+ * @param self pointer to object instance
+ * @return pointer to frozen image, NULL if error
+ */
+struct ihex_frozen *ihex_freeze(struct ihex_object *self);
+
+/**
+ * Delete frozen image.
+ * 
+ * @param frozen pointer to frozen image
+ */
+void ihex_frozen_delete(struct ihex_frozen *frozen);
+
+/**
+ * Get binary data from frozen image, unused addresses are filled with pad byte. Thread-safe.
+ * 
+ * @param frozen pointer to frozen image
+ * @param adr start address where from data should be read
+ * @param data pointer to place where data should be write
+ * @param size size of data to read
+ * @return 0 if no error, else if error
+ */
+int ihex_frozen_get_data(const struct ihex_frozen *frozen, uint32_t adr, uint8_t *data, uint32_t size);
+
+/**
+ * Get direct pointer to data stored inside of one range of frozen image (zero copy). Thread-safe.
+ * 
+ * @param frozen pointer to frozen image
+ * @param adr start address of requested data
+ * @param size size of requested data
+ * @param data pointer to place where data pointer should be write
+ * @return 0 if no error, else if error (range is not completely inside of one data range)
+ */
+int ihex_frozen_get_view(const struct ihex_frozen *frozen, uint32_t adr, uint32_t size, const uint8_t **data);
+#endif
+
 #endif /* __IHEX_H */
\ No newline at end of file
@@ -0,0 +1,352 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "ihex_hex.h"
+
+#include <stddef.h>
+
+#if defined(IHEX_HEX_SSE2) || defined(IHEX_HEX_AVX2)
+#include <immintrin.h>
+#endif
+
+#ifdef IHEX_HEX_NEON
+#include <arm_neon.h>
+#endif
+
+const uint8_t ihex_hex_table[256] = {
+	['0'] = 0x10, ['1'] = 0x11, ['2'] = 0x12, ['3'] = 0x13, ['4'] = 0x14, ['5'] = 0x15, ['6'] = 0x16, ['7'] = 0x17,
+	['8'] = 0x18, ['9'] = 0x19, ['A'] = 0x1A, ['B'] = 0x1B, ['C'] = 0x1C, ['D'] = 0x1D, ['E'] = 0x1E, ['F'] = 0x1F,
+	['a'] = 0x1A, ['b'] = 0x1B, ['c'] = 0x1C, ['d'] = 0x1D, ['e'] = 0x1E, ['f'] = 0x1F,
+};
+
+int ihex_hex_decode_scalar(const char *hex, uint8_t *data, uint32_t size, uint8_t *sum)
+{
+	uint8_t s;
+
+	s = *sum;
+	while (size > 0) {
+		if (ihex_get_hex_byte(hex, data) != 0)
+			return -1;
+		s += *data++;
+		hex += 2;
+		size--;
+	}
+	*sum = s;
+
+	return 0;
+}
+
+#ifdef IHEX_HEX_SSE2
+static inline __m128i ihex_sse2_decode8(__m128i c, int *valid)
+{
+	__m128i digit;
+	__m128i alpha;
+	__m128i lower;
+	__m128i nibble;
+	__m128i hi;
+	__m128i lo;
+
+	/* signed compares reject all non ascii characters */
+	digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+	lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+	alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+	*valid = _mm_movemask_epi8(_mm_or_si128(digit, alpha));
+
+	nibble = _mm_or_si128(_mm_and_si128(digit, _mm_sub_epi8(c, _mm_set1_epi8('0'))),
+			      _mm_and_si128(alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+
+	/* even characters are high nibbles, odd characters are low nibbles */
+	hi = _mm_and_si128(nibble, _mm_set1_epi16(0x00FF));
+	lo = _mm_srli_epi16(nibble, 8);
+
+	return _mm_packus_epi16(_mm_or_si128(_mm_slli_epi16(hi, 4), lo), _mm_setzero_si128());
+}
+
+int ihex_hex_decode_sse2(const char *hex, uint8_t *data, uint32_t size, uint8_t *sum)
+{
+	__m128i bytes;
+	__m128i acc;
+	int valid;
+	uint8_t s;
+
+	acc = _mm_setzero_si128();
+	while (size >= 8) {
+		bytes = ihex_sse2_decode8(_mm_loadu_si128((const __m128i *)hex), &valid);
+		if (valid != 0xFFFF)
+			return -1;
+		_mm_storel_epi64((__m128i *)data, bytes);
+		acc = _mm_add_epi64(acc, _mm_sad_epu8(bytes, _mm_setzero_si128()));
+		hex += 16;
+		data += 8;
+		size -= 8;
+	}
+
+	s = *sum + (uint8_t)_mm_cvtsi128_si32(acc);
+	if (ihex_hex_decode_scalar(hex, data, size, &s) != 0)
+		return -1;
+	*sum = s;
+
+	return 0;
+}
+#endif
+
+#ifdef IHEX_HEX_AVX2
+__attribute__((target("avx2"))) int ihex_hex_decode_avx2(const char *hex, uint8_t *data, uint32_t size, uint8_t *sum)
+{
+	__m256i c;
+	__m256i digit;
+	__m256i alpha;
+	__m256i lower;
+	__m256i nibble;
+	__m256i bytes;
+	__m256i acc;
+	__m128i acc128;
+	uint8_t s;
+
+	acc = _mm256_setzero_si256();
+	while (size >= 16) {
+		c = _mm256_loadu_si256((const __m256i *)hex);
+
+		digit = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+		lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+		alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+		if (_mm256_movemask_epi8(_mm256_or_si256(digit, alpha)) != -1)
+			return -1;
+
+		nibble = _mm256_or_si256(_mm256_and_si256(digit, _mm256_sub_epi8(c, _mm256_set1_epi8('0'))),
+					 _mm256_and_si256(alpha, _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10))));
+
+		bytes = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(nibble, _mm256_set1_epi16(0x00FF)), 4), _mm256_srli_epi16(nibble, 8));
+		bytes = _mm256_packus_epi16(bytes, _mm256_setzero_si256());
+		acc = _mm256_add_epi64(acc, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+
+		/* pack works per 128-bit lane, gather both low halves */
+		bytes = _mm256_permute4x64_epi64(bytes, 0x08);
+		_mm_storeu_si128((__m128i *)data, _mm256_castsi256_si128(bytes));
+
+		hex += 32;
+		data += 16;
+		size -= 16;
+	}
+
+	acc128 = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+	acc128 = _mm_add_epi64(acc128, _mm_unpackhi_epi64(acc128, acc128));
+	s = *sum + (uint8_t)_mm_cvtsi128_si32(acc128);
+	if (ihex_hex_decode_sse2(hex, data, size, &s) != 0)
+		return -1;
+	*sum = s;
+
+	return 0;
+}
+#endif
+
+#ifdef IHEX_HEX_NEON
+static inline uint8x16_t ihex_neon_nibble(uint8x16_t c, uint8x16_t *valid)
+{
+	uint8x16_t digit;
+	uint8x16_t alpha;
+	uint8x16_t d;
+	uint8x16_t a;
+
+	/* unsigned wrap around makes each range check a single compare */
+	d = vsubq_u8(c, vdupq_n_u8('0'));
+	a = vsubq_u8(vorrq_u8(c, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+	digit = vcltq_u8(d, vdupq_n_u8(10));
+	alpha = vcltq_u8(a, vdupq_n_u8(6));
+	*valid = vorrq_u8(digit, alpha);
+
+	return vbslq_u8(digit, d, vaddq_u8(a, vdupq_n_u8(10)));
+}
+
+int ihex_hex_decode_neon(const char *hex, uint8_t *data, uint32_t size, uint8_t *sum)
+{
+	uint8x16x2_t c;
+	uint8x16_t hi;
+	uint8x16_t lo;
+	uint8x16_t valid_hi;
+	uint8x16_t valid_lo;
+	uint8x16_t bytes;
+	uint64x2_t valid;
+	uint16x8_t acc;
+	uint64x2_t total;
+	uint8_t s;
+
+	s = *sum;
+	while (size >= 16) {
+		/* deinterleave even (high nibble) and odd (low nibble) characters */
+		c = vld2q_u8((const uint8_t *)hex);
+		hi = ihex_neon_nibble(c.val[0], &valid_hi);
+		lo = ihex_neon_nibble(c.val[1], &valid_lo);
+		valid = vreinterpretq_u64_u8(vandq_u8(valid_hi, valid_lo));
+		if ((vgetq_lane_u64(valid, 0) & vgetq_lane_u64(valid, 1)) != UINT64_MAX)
+			return -1;
+
+		bytes = vorrq_u8(vshlq_n_u8(hi, 4), lo);
+		vst1q_u8(data, bytes);
+
+		acc = vpaddlq_u8(bytes);
+		total = vpaddlq_u32(vpaddlq_u16(acc));
+		s += (uint8_t)(vgetq_lane_u64(total, 0) + vgetq_lane_u64(total, 1));
+
+		hex += 32;
+		data += 16;
+		size -= 16;
+	}
+
+	if (ihex_hex_decode_scalar(hex, data, size, &s) != 0)
+		return -1;
+	*sum = s;
+
+	return 0;
+}
+#endif
+
+static const char ihex_hex_digits[16] = "0123456789ABCDEF";
+
+void ihex_hex_encode_scalar(const uint8_t *data, char *hex, uint32_t size, uint8_t *sum)
+{
+	uint8_t s;
+
+	s = *sum;
+	while (size > 0) {
+		hex[0] = ihex_hex_digits[*data >> 4];
+		hex[1] = ihex_hex_digits[*data & 0x0F];
+		s += *data++;
+		hex += 2;
+		size--;
+	}
+	*sum = s;
+}
+
+#ifdef IHEX_HEX_SSE2
+static inline __m128i ihex_sse2_ascii(__m128i nibble)
+{
+	/* '0'..'9' for 0..9, 'A'..'F' for 10..15 */
+	return _mm_add_epi8(_mm_add_epi8(nibble, _mm_set1_epi8('0')), _mm_and_si128(_mm_cmpgt_epi8(nibble, _mm_set1_epi8(9)), _mm_set1_epi8('A' - '9' - 1)));
+}
+
+void ihex_hex_encode_sse2(const uint8_t *data, char *hex, uint32_t size, uint8_t *sum)
+{
+	__m128i bytes;
+	__m128i hi;
+	__m128i lo;
+	__m128i acc;
+	uint8_t s;
+
+	acc = _mm_setzero_si128();
+	while (size >= 16) {
+		bytes = _mm_loadu_si128((const __m128i *)data);
+		hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0F));
+		lo = _mm_and_si128(bytes, _mm_set1_epi8(0x0F));
+		_mm_storeu_si128((__m128i *)hex, ihex_sse2_ascii(_mm_unpacklo_epi8(hi, lo)));
+		_mm_storeu_si128((__m128i *)&hex[16], ihex_sse2_ascii(_mm_unpackhi_epi8(hi, lo)));
+		acc = _mm_add_epi64(acc, _mm_sad_epu8(bytes, _mm_setzero_si128()));
+		data += 16;
+		hex += 32;
+		size -= 16;
+	}
+
+	acc = _mm_add_epi64(acc, _mm_unpackhi_epi64(acc, acc));
+	s = *sum + (uint8_t)_mm_cvtsi128_si32(acc);
+	ihex_hex_encode_scalar(data, hex, size, &s);
+	*sum = s;
+}
+#endif
+
+#ifdef IHEX_HEX_NEON
+static inline uint8x16_t ihex_neon_ascii(uint8x16_t nibble)
+{
+	return vaddq_u8(vaddq_u8(nibble, vdupq_n_u8('0')), vandq_u8(vcgtq_u8(nibble, vdupq_n_u8(9)), vdupq_n_u8('A' - '9' - 1)));
+}
+
+void ihex_hex_encode_neon(const uint8_t *data, char *hex, uint32_t size, uint8_t *sum)
+{
+	uint8x16_t bytes;
+	uint8x16x2_t nibbles;
+	uint64x2_t total;
+	uint8_t s;
+
+	s = *sum;
+	while (size >= 16) {
+		bytes = vld1q_u8(data);
+		nibbles = vzipq_u8(vshrq_n_u8(bytes, 4), vandq_u8(bytes, vdupq_n_u8(0x0F)));
+		vst1q_u8((uint8_t *)hex, ihex_neon_ascii(nibbles.val[0]));
+		vst1q_u8((uint8_t *)&hex[16], ihex_neon_ascii(nibbles.val[1]));
+		total = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(bytes)));
+		s += (uint8_t)(vgetq_lane_u64(total, 0) + vgetq_lane_u64(total, 1));
+		data += 16;
+		hex += 32;
+		size -= 16;
+	}
+
+	ihex_hex_encode_scalar(data, hex, size, &s);
+	*sum = s;
+}
+#endif
+
+void ihex_hex_encode(const uint8_t *data, char *hex, uint32_t size, uint8_t *sum)
+{
+#if defined(IHEX_HEX_SSE2)
+	ihex_hex_encode_sse2(data, hex, size, sum);
+#elif defined(IHEX_HEX_NEON)
+	ihex_hex_encode_neon(data, hex, size, sum);
+#else
+	ihex_hex_encode_scalar(data, hex, size, sum);
+#endif
+}
+
+ihex_hex_decode_t ihex_hex_select(void)
+{
+#ifdef IHEX_HEX_AVX2
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return ihex_hex_decode_avx2;
+#endif
+#ifdef IHEX_HEX_SSE2
+	return ihex_hex_decode_sse2;
+#endif
+#ifdef IHEX_HEX_NEON
+	return ihex_hex_decode_neon;
+#endif
+	return ihex_hex_decode_scalar;
+}
+
+static int ihex_hex_decode_init(const char *hex, uint8_t *data, uint32_t size, uint8_t *sum);
+
+/* selected kernel, replaced on first call; parallel parse workers may race here, so access is atomic */
+static ihex_hex_decode_t ihex_hex_decode_kernel = ihex_hex_decode_init;
+
+static int ihex_hex_decode_init(const char *hex, uint8_t *data, uint32_t size, uint8_t *sum)
+{
+	ihex_hex_decode_t kernel;
+
+	kernel = ihex_hex_select();
+	__atomic_store_n(&ihex_hex_decode_kernel, kernel, __ATOMIC_RELAXED);
+	return kernel(hex, data, size, sum);
+}
+
+int ihex_hex_decode(const char *hex, uint8_t *data, uint32_t size, uint8_t *sum)
+{
+	return __atomic_load_n(&ihex_hex_decode_kernel, __ATOMIC_RELAXED)(hex, data, size, sum);
+}
@@ -0,0 +1,130 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __IHEX_HEX_H
+#define __IHEX_HEX_H
+
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#define IHEX_HEX_SSE2 1 /* x86 SSE2 kernel compiled in (baseline on x86-64) */
+#if defined(__GNUC__)
+#define IHEX_HEX_AVX2 1 /* x86 AVX2 kernel compiled in, used when supported by cpu */
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define IHEX_HEX_NEON 1 /* ARM NEON kernel compiled in */
+#endif
+
+/**
+ * Hex decoding kernel type.
+ * Decodes size bytes from 2 * size ascii hex characters and adds all decoded bytes to checksum.
+ * 
+ * @param hex pointer to ascii hex characters
+ * @param data pointer to place where decoded bytes should be written
+ * @param size number of bytes to decode
+ * @param sum pointer to checksum which is increased by decoded bytes
+ * @return 0 if no error, else if not hex character found (data and sum are undefined then)
+ */
+typedef int (*ihex_hex_decode_t)(const char *hex, uint8_t *data, uint32_t size, uint8_t *sum);
+
+extern const uint8_t ihex_hex_table[256]; /* ascii to nibble lookup table, bit 4 marks valid hex characters */
+
+/**
+ * Decode one byte from two ascii hex characters.
+ * 
+ * @param hex pointer to ascii hex characters
+ * @param byte pointer to decoded byte
+ * @return 0 if no error, else if not hex character found
+ */
+static inline int ihex_get_hex_byte(const char *hex, uint8_t *byte)
+{
+	uint8_t hi;
+	uint8_t lo;
+
+	hi = ihex_hex_table[(uint8_t)hex[0]];
+	lo = ihex_hex_table[(uint8_t)hex[1]];
+	if ((hi & lo & 0x10) == 0)
+		return -1;
+	*byte = (uint8_t)(hi << 4) | (lo & 0x0F);
+
+	return 0;
+}
+
+int ihex_hex_decode_scalar(const char *hex, uint8_t *data, uint32_t size, uint8_t *sum);
+
+#ifdef IHEX_HEX_SSE2
+int ihex_hex_decode_sse2(const char *hex, uint8_t *data, uint32_t size, uint8_t *sum);
+#endif
+
+#ifdef IHEX_HEX_AVX2
+int ihex_hex_decode_avx2(const char *hex, uint8_t *data, uint32_t size, uint8_t *sum);
+#endif
+
+#ifdef IHEX_HEX_NEON
+int ihex_hex_decode_neon(const char *hex, uint8_t *data, uint32_t size, uint8_t *sum);
+#endif
+
+/**
+ * Select fastest hex decoding kernel supported by running cpu.
+ * 
+ * @return pointer to kernel function
+ */
+ihex_hex_decode_t ihex_hex_select(void);
+
+/**
+ * Decode ascii hex characters with fastest kernel supported by running cpu.
+ * Kernel is selected on first call.
+ * 
+ * @param hex pointer to ascii hex characters
+ * @param data pointer to place where decoded bytes should be written
+ * @param size number of bytes to decode
+ * @param sum pointer to checksum which is increased by decoded bytes
+ * @return 0 if no error, else if not hex character found
+ */
+int ihex_hex_decode(const char *hex, uint8_t *data, uint32_t size, uint8_t *sum);
+
+/**
+ * Encode bytes as uppercase ascii hex characters and add them to checksum.
+ * Uses fastest kernel available at compile time (SSE2 and NEON are baseline on their targets).
+ * 
+ * @param data pointer to bytes to encode
+ * @param hex pointer to place where 2 * size characters should be written
+ * @param size number of bytes to encode
+ * @param sum pointer to checksum which is increased by encoded bytes
+ */
+void ihex_hex_encode(const uint8_t *data, char *hex, uint32_t size, uint8_t *sum);
+
+void ihex_hex_encode_scalar(const uint8_t *data, char *hex, uint32_t size, uint8_t *sum);
+
+#ifdef IHEX_HEX_SSE2
+void ihex_hex_encode_sse2(const uint8_t *data, char *hex, uint32_t size, uint8_t *sum);
+#endif
+
+#ifdef IHEX_HEX_NEON
+void ihex_hex_encode_neon(const uint8_t *data, char *hex, uint32_t size, uint8_t *sum);
+#endif
+
+#endif /* __IHEX_HEX_H */
@@ -0,0 +1,161 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ihex.h>
+
+#define REGION_COUNT 3
+#define REGION_SIZE 4096
+#define RECORD_COUNT (REGION_COUNT * REGION_SIZE / 16)
+#define MAX_SEGMENTS 8
+
+static char *dump_record(char *out, uint16_t adr, uint8_t type, const uint8_t *data, uint8_t size)
+{
+	uint8_t sum;
+	int i;
+
+	sum = size + (adr >> 8) + (adr & 0xFF) + type;
+	out += sprintf(out, ":%02X%04X%02X", size, adr, type);
+	for (i = 0; i < size; i++) {
+		out += sprintf(out, "%02X", data[i]);
+		sum += data[i];
+	}
+	out += sprintf(out, "%02X\n", (uint8_t)(0x100 - sum));
+
+	return out;
+}
+
+static char *create_shuffled_hex(const uint8_t *image, size_t *length)
+{
+	uint32_t order[RECORD_COUNT];
+	uint32_t i;
+	uint32_t j;
+	uint32_t tmp;
+	uint32_t adr;
+	uint8_t upper[2];
+	char *hex;
+	char *out;
+
+	for (i = 0; i < RECORD_COUNT; i++)
+		order[i] = i;
+	srand(1);
+	for (i = RECORD_COUNT - 1; i > 0; i--) {
+		j = rand() % (i + 1);
+		tmp = order[i];
+		order[i] = order[j];
+		order[j] = tmp;
+	}
+
+	hex = malloc(RECORD_COUNT * 64 + 64);
+	assert(hex != NULL);
+
+	/* regions are 64 KiB apart, each record carries its own extended address */
+	out = hex;
+	for (i = 0; i < RECORD_COUNT; i++) {
+		adr = (order[i] / (REGION_SIZE / 16)) * 0x10000 + (order[i] % (REGION_SIZE / 16)) * 16;
+		upper[0] = 0x08;
+		upper[1] = adr >> 16;
+		out = dump_record(out, 0, 0x04, upper, 2);
+		out = dump_record(out, adr & 0xFFFF, 0x00, &image[order[i] * 16], 16);
+	}
+	out = dump_record(out, 0, 0x01, NULL, 0);
+
+	*length = out - hex;
+	return hex;
+}
+
+static uint32_t get_segments(struct ihex_object *ihex, const uint8_t **data)
+{
+	struct ihex_segment_iterator iter;
+	uint32_t adr;
+	uint32_t size;
+	uint32_t count;
+
+	count = 0;
+	ihex_segment_iterator_init(ihex, &iter);
+	while (ihex_segment_iterator_next(&iter, &adr, &data[count], &size) != 0) {
+		assert(count < MAX_SEGMENTS);
+		assert(adr == 0x08000000 + count * 0x10000);
+		assert(size == REGION_SIZE);
+		count++;
+	}
+
+	return count;
+}
+
+int main(int argc, char **argv)
+{
+	struct ihex_object *ihex;
+	uint8_t image[REGION_COUNT * REGION_SIZE];
+	const uint8_t *data[MAX_SEGMENTS];
+	const uint8_t *data_first[MAX_SEGMENTS];
+	char *hex;
+	size_t length;
+	uint32_t i;
+	int cycle;
+
+	for (i = 0; i < sizeof(image); i++)
+		image[i] = (uint8_t)(i * 13 + (i >> 8));
+	hex = create_shuffled_hex(image, &length);
+
+	/* arena object, memory layout is identical in every cycle after reset */
+	ihex = ihex_new_arena(1024);
+	assert(ihex != NULL);
+	ihex->pad_byte = 0x00;
+	for (cycle = 0; cycle < 4; cycle++) {
+		assert(ihex_parse_buffer(ihex, hex, length) == 0);
+		assert(get_segments(ihex, data) == REGION_COUNT);
+		for (i = 0; i < REGION_COUNT; i++)
+			assert(memcmp(data[i], &image[i * REGION_SIZE], REGION_SIZE) == 0);
+		if (cycle == 0)
+			memcpy(data_first, data, sizeof(data));
+		else
+			assert(memcmp(data_first, data, sizeof(data)) == 0);
+		ihex_reset(ihex);
+		assert(ihex->segments == NULL);
+		assert(ihex->pad_byte == 0x00);
+	}
+	ihex_delete(ihex);
+
+	/* heap object reset */
+	ihex = ihex_new();
+	assert(ihex != NULL);
+	for (cycle = 0; cycle < 2; cycle++) {
+		assert(ihex_parse_buffer(ihex, hex, length) == 0);
+		assert(get_segments(ihex, data) == REGION_COUNT);
+		ihex_reset(ihex);
+		assert(ihex->segments == NULL);
+	}
+	assert(ihex_parse_buffer(ihex, ":00000001FF\n", 12) == 0);
+	assert(get_segments(ihex, data) == 0);
+	ihex_delete(ihex);
+
+	free(hex);
+
+	return 0;
+}
@@ -0,0 +1,167 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+
+#include <ihex.h>
+
+static char input_hex[] =
+":020000040800F2\n"
+":0C000400FFFF0120E50A0008290B00089E\n"
+":04001000290B0008B0\n"
+":020000040000FA\n"
+":08FFF8003A3032303030303075\n"
+":020000040001F9\n"
+":10000000343038303046320A3A31303030303430E3\n"
+":0800100030464646463031320D\n"
+":00000001FF\n";
+
+static char input_hex_crlf[] =
+":020000040800F2\r\n"
+":0C000400FFFF0120E50A0008290B00089E\r\n"
+":04001000290B0008B0\r\n"
+":020000040000FA\r\n"
+":08FFF8003A3032303030303075\r\n"
+":020000040001F9\r\n"
+":10000000343038303046320A3A31303030303430E3\r\n"
+":0800100030464646463031320D\r\n"
+":00000001FF\r\n";
+
+/* record with maximal data size, then records decoded directly behind it (the last one with broken checksum) */
+static char input_long_hex[] =
+":FF200000000306090C0F1215181B1E2124272A2D303336393C3F4245484B4E5154575A5D60636"
+"6696C6F7275787B7E8184878A8D909396999C9FA2A5A8ABAEB1B4B7BABDC0C3C6C9CCCFD2D5D8D"
+"BDEE1E4E7EAEDF0F3F6F9FCFF0205080B0E1114171A1D202326292C2F3235383B3E4144474A4D5"
+"05356595C5F6265686B6E7174777A7D808386898C8F9295989B9EA1A4A7AAADB0B3B6B9BCBFC2C"
+"5C8CBCED1D4D7DADDE0E3E6E9ECEFF2F5F8FBFE0104070A0D101316191C1F2225282B2E3134373"
+"A3D404346494C4F5255585B5E6164676A6D707376797C7F8285888B8E9194979A9DA0A3A6A9ACA"
+"FB2B5B8BBBEC1C4C7CACDD0D3D6D9DCDFE2E5E8EBEEF1F4F7FA5E\n"
+":1020FF00808182838485868788898A8B8C8D8E8F59\n";
+
+static char input_broken_tail_hex[] =
+":10210F00808182838485868788898A8B8C8D8E8F49\n";
+
+static void check_segments(struct ihex_object *ihex)
+{
+	struct ihex_data_segment *seg;
+
+	seg = ihex->segments;
+	assert(seg != NULL);
+	assert(seg->adr_start == 0x0000FFF8);
+	assert(seg->data_size == 32);
+	assert(memcmp(seg->data, ":020000040800F2\n:10000400FFFF012", 32) == 0);
+	/* segment grown by three records is shrunk to fit at end of parsing */
+	assert(seg->capacity == seg->data_size);
+	assert(seg->data == seg->buffer);
+
+	seg = seg->next;
+	assert(seg != NULL);
+	assert(seg->adr_start == 0x08000004);
+	assert(seg->data_size == 16);
+	assert(memcmp(seg->data, "\xFF\xFF\x01\x20\xE5\x0A\x00\x08\x29\x0B\x00\x08\x29\x0B\x00\x08", 16) == 0);
+	assert(seg->capacity == seg->data_size);
+	assert(seg->next == NULL);
+}
+
+int main(int argc, char **argv)
+{
+	struct ihex_object *ihex;
+	struct ihex_data_segment *seg;
+	char path[] = "/tmp/test_buffer_XXXXXX";
+	int fd;
+	int i;
+
+	ihex = ihex_new();
+	assert(ihex != NULL);
+	assert(ihex_parse_buffer(ihex, input_hex, strlen(input_hex)) == 0);
+	check_segments(ihex);
+	ihex_delete(ihex);
+
+	ihex = ihex_new();
+	assert(ihex != NULL);
+	assert(ihex_parse_buffer(ihex, input_hex_crlf, strlen(input_hex_crlf)) == 0);
+	check_segments(ihex);
+	ihex_delete(ihex);
+
+	/* missing EOF record */
+	ihex = ihex_new();
+	assert(ihex != NULL);
+	assert(ihex_parse_buffer(ihex, input_hex, strlen(input_hex) - 12) != 0);
+	assert(ihex->error == IHEX_ERROR_NO_EOF_LINE);
+	ihex_delete(ihex);
+
+	/* EOL missing in last line */
+	ihex = ihex_new();
+	assert(ihex != NULL);
+	assert(ihex_parse_buffer(ihex, input_hex, strlen(input_hex) - 1) != 0);
+	assert(ihex->error == IHEX_ERROR_LINE_LENGTH);
+	ihex_delete(ihex);
+
+	ihex = ihex_new();
+	assert(ihex != NULL);
+	ihex_parse_begin(ihex);
+	assert(ihex_parse_chunk(ihex, input_long_hex, strlen(input_long_hex)) == 0);
+	seg = ihex->segments;
+	assert((seg != NULL) && (seg->next == NULL));
+	assert((seg->adr_start == 0x2000) && (seg->data_size == 255 + 16));
+	for (i = 0; i < 255; i++)
+		assert(seg->data[i] == (uint8_t)(i * 3));
+	for (i = 0; i < 16; i++)
+		assert(seg->data[255 + i] == 0x80 + i);
+
+	/* record failing checksum after its data were decoded in place does not extend segment */
+	assert(ihex_parse_chunk(ihex, input_broken_tail_hex, strlen(input_broken_tail_hex)) != 0);
+	assert(ihex->error == IHEX_ERROR_CHECKSUM);
+	assert((ihex->segments == seg) && (seg->next == NULL));
+	assert(seg->data_size == 255 + 16);
+	assert(seg->data[255 + 15] == 0x8F);
+	ihex_delete(ihex);
+
+	fd = mkstemp(path);
+	assert(fd >= 0);
+	assert(write(fd, input_hex_crlf, strlen(input_hex_crlf)) == (ssize_t)strlen(input_hex_crlf));
+	close(fd);
+
+	ihex = ihex_new();
+	assert(ihex != NULL);
+	assert(ihex_parse_path(ihex, path) == 0);
+	check_segments(ihex);
+	ihex_delete(ihex);
+
+	unlink(path);
+
+	ihex = ihex_new();
+	assert(ihex != NULL);
+	assert(ihex_parse_path(ihex, path) != 0);
+	assert(ihex->error == IHEX_ERROR_FILE);
+	ihex_delete(ihex);
+
+	return 0;
+}
@@ -0,0 +1,170 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ihex.h>
+
+#define RECORD_COUNT 4096
+
+static char *dump_record(char *out, uint16_t adr, uint8_t type, const uint8_t *data, uint8_t size)
+{
+	uint8_t sum;
+	int i;
+
+	sum = size + (adr >> 8) + (adr & 0xFF) + type;
+	out += sprintf(out, ":%02X%04X%02X", size, adr, type);
+	for (i = 0; i < size; i++) {
+		out += sprintf(out, "%02X", data[i]);
+		sum += data[i];
+	}
+	out += sprintf(out, "%02X\n", (uint8_t)(0x100 - sum));
+
+	return out;
+}
+
+/* records of variable size in random order, every 8th record is followed by gap */
+static char *create_shuffled_hex(size_t *length)
+{
+	uint32_t adr[RECORD_COUNT];
+	uint8_t size[RECORD_COUNT];
+	uint8_t data[32];
+	uint8_t upper[2];
+	uint32_t tmp;
+	uint32_t i;
+	uint32_t j;
+	char *hex;
+	char *out;
+
+	srand(1);
+	tmp = 0x0800FF00;
+	for (i = 0; i < RECORD_COUNT; i++) {
+		adr[i] = tmp;
+		size[i] = 1 + rand() % 32;
+		tmp += size[i] + ((i % 8 == 7) ? 5 : 0);
+	}
+	for (i = RECORD_COUNT - 1; i > 0; i--) {
+		j = rand() % (i + 1);
+		tmp = adr[i];
+		adr[i] = adr[j];
+		adr[j] = tmp;
+		tmp = size[i];
+		size[i] = size[j];
+		size[j] = tmp;
+	}
+
+	hex = malloc(RECORD_COUNT * 96 + 64);
+	assert(hex != NULL);
+
+	out = hex;
+	for (i = 0; i < RECORD_COUNT; i++) {
+		for (j = 0; j < size[i]; j++)
+			data[j] = (uint8_t)(adr[i] + j);
+		upper[0] = adr[i] >> 24;
+		upper[1] = adr[i] >> 16;
+		out = dump_record(out, 0, 0x04, upper, 2);
+		out = dump_record(out, adr[i] & 0xFFFF, 0x00, data, size[i]);
+	}
+	out = dump_record(out, 0, 0x01, NULL, 0);
+
+	*length = out - hex;
+	return hex;
+}
+
+static void compare_segments(struct ihex_object *a, struct ihex_object *b)
+{
+	struct ihex_segment_iterator iter_a;
+	struct ihex_segment_iterator iter_b;
+	const uint8_t *data_a;
+	const uint8_t *data_b;
+	uint32_t adr_a;
+	uint32_t adr_b;
+	uint32_t size_a;
+	uint32_t size_b;
+	int next;
+
+	ihex_segment_iterator_init(a, &iter_a);
+	ihex_segment_iterator_init(b, &iter_b);
+	do {
+		next = ihex_segment_iterator_next(&iter_a, &adr_a, &data_a, &size_a);
+		assert(ihex_segment_iterator_next(&iter_b, &adr_b, &data_b, &size_b) == next);
+		if (next != 0) {
+			assert(adr_a == adr_b);
+			assert(size_a == size_b);
+			assert(memcmp(data_a, data_b, size_a) == 0);
+		}
+	} while (next != 0);
+}
+
+int main(int argc, char **argv)
+{
+	struct ihex_object *incremental;
+	struct ihex_object *bulk;
+	static const uint8_t before[4] = { 0xAA, 0xBB, 0xCC, 0xDD };
+	char *hex;
+	size_t length;
+
+	hex = create_shuffled_hex(&length);
+
+	incremental = ihex_new();
+	bulk = ihex_new();
+	assert((incremental != NULL) && (bulk != NULL));
+	ihex_set_bulk_load(bulk, 1);
+
+	assert(ihex_parse_buffer(incremental, hex, length) == 0);
+	assert(ihex_parse_buffer(bulk, hex, length) == 0);
+	compare_segments(incremental, bulk);
+	assert(bulk->segments->capacity == bulk->segments->data_size);
+
+	/* parsed data joining already existing segment */
+	ihex_reset(incremental);
+	ihex_reset(bulk);
+	assert(ihex_set_data(incremental, 0x0800FEFC, (uint8_t *)before, sizeof(before)) == 0);
+	assert(ihex_set_data(bulk, 0x0800FEFC, (uint8_t *)before, sizeof(before)) == 0);
+	assert(ihex_parse_buffer(incremental, hex, length) == 0);
+	assert(ihex_parse_buffer(bulk, hex, length) == 0);
+	compare_segments(incremental, bulk);
+
+	/* overlapping with already existing segment and between parsed records */
+	assert(ihex_parse_buffer(bulk, hex, length) != 0);
+	assert(bulk->error == IHEX_ERROR_DATA_OVERLAPPING);
+	ihex_reset(bulk);
+	assert(ihex_parse_buffer(bulk, ":0400000001020304F2\n:02000200AABB97\n:00000001FF\n", 48) != 0);
+	assert(bulk->error == IHEX_ERROR_DATA_OVERLAPPING);
+
+	/* data are merged also without EOF record */
+	ihex_reset(bulk);
+	assert(ihex_parse_buffer(bulk, ":0400000001020304F2\n", 20) != 0);
+	assert(bulk->error == IHEX_ERROR_NO_EOF_LINE);
+	assert((bulk->segments != NULL) && (bulk->segments->data_size == 4));
+
+	ihex_delete(incremental);
+	ihex_delete(bulk);
+	free(hex);
+
+	return 0;
+}
@@ -0,0 +1,103 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ihex.h>
+
+static char input_hex[] =
+":020000040800F2\n"
+":0C000400FFFF0120E50A0008290B00089E\n"
+":04001000290B0008B0\n"
+":020000040000FA\n"
+":08FFF8003A3032303030303075\n"
+":020000040001F9\n"
+":10000000343038303046320A3A31303030303430E3\n"
+":0800100030464646463031320D\n"
+":00000001FF\n";
+
+struct visit {
+	int records;
+	int stop_after;
+	uint32_t adr[8];
+	uint8_t size[8];
+	uint32_t bytes;
+	uint8_t sum;
+};
+
+static int visit_record(void *ctx, uint32_t adr, const uint8_t *data, uint8_t size)
+{
+	struct visit *v = (struct visit *)ctx;
+	uint8_t i;
+
+	v->adr[v->records] = adr;
+	v->size[v->records] = size;
+	v->bytes += size;
+	for (i = 0; i < size; i++)
+		v->sum += data[i];
+	v->records++;
+
+	return (v->records == v->stop_after);
+}
+
+int main(int argc, char **argv)
+{
+	struct ihex_object *ihex;
+	struct visit v;
+
+	memset(&v, 0, sizeof(v));
+
+	ihex = ihex_new();
+	assert(ihex != NULL);
+	ihex_set_data_callback(ihex, visit_record, &v);
+	assert(ihex_parse_buffer(ihex, input_hex, strlen(input_hex)) == 0);
+	assert(ihex->segments == NULL);
+
+	assert(v.records == 5);
+	assert(v.bytes == 48);
+	assert(v.adr[0] == 0x08000004);
+	assert(v.size[0] == 12);
+	assert(v.adr[1] == 0x08000010);
+	assert(v.adr[2] == 0x0000FFF8);
+	assert(v.adr[3] == 0x00010000);
+	assert(v.size[3] == 16);
+	assert(v.adr[4] == 0x00010010);
+	ihex_delete(ihex);
+
+	/* early stop */
+	memset(&v, 0, sizeof(v));
+	v.stop_after = 2;
+
+	ihex = ihex_new();
+	assert(ihex != NULL);
+	ihex_set_data_callback(ihex, visit_record, &v);
+	assert(ihex_parse_buffer(ihex, input_hex, strlen(input_hex)) == 0);
+	assert(v.records == 2);
+	assert(v.bytes == 16);
+	ihex_delete(ihex);
+
+	return 0;
+}
@@ -0,0 +1,108 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ihex.h>
+
+static char input_hex[] =
+":020000040800F2\r\n"
+":0C000400FFFF0120E50A0008290B00089E\r\n"
+":04001000290B0008B0\r\n"
+":020000040000FA\r\n"
+":08FFF8003A3032303030303075\r\n"
+":020000040001F9\r\n"
+":10000000343038303046320A3A31303030303430E3\r\n"
+":0800100030464646463031320D\r\n"
+":00000001FF\r\n"
+"ignored garbage after EOF line";
+
+static void parse_in_chunks(struct ihex_object *ihex, size_t chunk_size)
+{
+	size_t offset;
+	size_t size;
+
+	ihex_parse_begin(ihex);
+	offset = 0;
+	while (offset < sizeof(input_hex)) {
+		size = sizeof(input_hex) - offset;
+		if (size > chunk_size)
+			size = chunk_size;
+		assert(ihex_parse_chunk(ihex, &input_hex[offset], size) == 0);
+		offset += size;
+	}
+	assert(ihex_parse_end(ihex) == 0);
+}
+
+int main(int argc, char **argv)
+{
+	struct ihex_object *ihex;
+	struct ihex_data_segment *seg;
+	size_t chunk_size;
+
+	for (chunk_size = 1; chunk_size <= sizeof(input_hex); chunk_size++) {
+		ihex = ihex_new();
+		assert(ihex != NULL);
+
+		parse_in_chunks(ihex, chunk_size);
+
+		seg = ihex->segments;
+		assert(seg != NULL);
+		assert(seg->adr_start == 0x0000FFF8);
+		assert(seg->data_size == 32);
+		assert(memcmp(seg->data, ":020000040800F2\n:10000400FFFF012", 32) == 0);
+
+		seg = seg->next;
+		assert(seg != NULL);
+		assert(seg->adr_start == 0x08000004);
+		assert(seg->data_size == 16);
+		assert(memcmp(seg->data, "\xFF\xFF\x01\x20\xE5\x0A\x00\x08\x29\x0B\x00\x08\x29\x0B\x00\x08", 16) == 0);
+		assert(seg->next == NULL);
+
+		ihex_delete(ihex);
+	}
+
+	/* partial line without EOF record */
+	ihex = ihex_new();
+	assert(ihex != NULL);
+	ihex_parse_begin(ihex);
+	assert(ihex_parse_chunk(ihex, input_hex, 20) == 0);
+	assert(ihex_parse_end(ihex) != 0);
+	ihex_delete(ihex);
+
+	/* broken record in second chunk */
+	ihex = ihex_new();
+	assert(ihex != NULL);
+	ihex_parse_begin(ihex);
+	assert(ihex_parse_chunk(ihex, input_hex, 17) == 0);
+	assert(ihex_parse_chunk(ihex, "X0C000400FFFF0120", 17) == 0);
+	assert(ihex_parse_chunk(ihex, "\r\n", 2) != 0);
+	assert(ihex->error == IHEX_ERROR_PARSING_START_LINE);
+	assert(ihex_parse_end(ihex) != 0);
+	ihex_delete(ihex);
+
+	return 0;
+}
@@ -0,0 +1,84 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ihex.h>
+
+static uint8_t blob[64];
+
+int main(int argc, char **argv)
+{
+	struct ihex_object *ihex;
+	struct ihex_data_segment *seg;
+	size_t dump_size;
+	uint32_t i;
+
+	for (i = 0; i < sizeof(blob); i++)
+		blob[i] = (uint8_t)(i * 9 + 1);
+
+	ihex = ihex_new();
+	assert(ihex != NULL);
+
+	/* sections separated by small gaps and one big gap */
+	assert(ihex_set_data(ihex, 0x1000, &blob[0], 14) == 0);
+	assert(ihex_set_data(ihex, 0x1010, &blob[16], 10) == 0);
+	assert(ihex_set_data(ihex, 0x101C, &blob[28], 4) == 0);
+	assert(ihex_set_data(ihex, 0x1040, &blob[32], 32) == 0);
+	assert(ihex->index_count == 4);
+
+	/* zero gap changes nothing */
+	assert(ihex_compact(ihex, 0) == 0);
+	assert(ihex->index_count == 4);
+
+	dump_size = ihex_dump_size(ihex);
+	assert(ihex_compact(ihex, 4) == 0);
+	assert(ihex->index_count == 2);
+	assert(ihex_dump_size(ihex) < dump_size);
+
+	seg = ihex->segments;
+	assert((seg->adr_start == 0x1000) && (seg->data_size == 32) && (seg->capacity == 32));
+	assert(memcmp(&seg->data[0], &blob[0], 14) == 0);
+	assert((seg->data[14] == ihex->pad_byte) && (seg->data[15] == ihex->pad_byte));
+	assert(memcmp(&seg->data[16], &blob[16], 10) == 0);
+	assert((seg->data[26] == ihex->pad_byte) && (seg->data[27] == ihex->pad_byte));
+	assert(memcmp(&seg->data[28], &blob[28], 4) == 0);
+
+	seg = seg->next;
+	assert((seg->adr_start == 0x1040) && (seg->data_size == 32) && (seg->next == NULL));
+	assert(seg->prev == ihex->segments);
+	assert((ihex->index_count == 2) && (ihex->index_root->height == 2));
+
+	/* merge over big gap */
+	assert(ihex_compact(ihex, 0x20) == 0);
+	assert(ihex->index_count == 1);
+	assert(ihex->segments->data_size == 0x60);
+	assert(memcmp(&ihex->segments->data[0x40], &blob[32], 32) == 0);
+
+	ihex_delete(ihex);
+
+	return 0;
+}
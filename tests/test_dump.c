@@ -22,6 +22,8 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
@@ -55,6 +57,10 @@ int main(int argc, char **argv)
         FILE *fp;
         struct ihex_data_segment *seg;
         char out[512];
+	struct ihex_encoder *enc;
+	size_t total;
+	size_t size;
+	size_t cap;
 
 	ihex = ihex_new();
         assert(ihex != NULL);
@@ -69,6 +75,30 @@ int main(int argc, char **argv)
 
         assert(memcmp(out, output_hex, sizeof(output_hex)) == 0);
 
+	assert(ihex_dump_size(ihex) == sizeof(output_hex) - 1);
+
+	memset(out, 0, sizeof(out));
+	assert(ihex_dump_buffer(ihex, out, sizeof(output_hex) - 1) == 0);
+	assert(memcmp(out, output_hex, sizeof(output_hex)) == 0);
+
+	assert(ihex_dump_buffer(ihex, out, sizeof(output_hex) - 2) != 0);
+	assert(ihex->error == IHEX_ERROR_DUMP);
+
+	for (cap = 1; cap < sizeof(out); cap++) {
+		enc = ihex_encoder_new(ihex);
+		assert(enc != NULL);
+		memset(out, 0, sizeof(out));
+		total = 0;
+		while ((size = ihex_encoder_read(enc, &out[total], cap)) > 0) {
+			assert(size <= cap);
+			total += size;
+			assert(total < sizeof(out));
+		}
+		assert(total == sizeof(output_hex) - 1);
+		assert(memcmp(out, output_hex, sizeof(output_hex)) == 0);
+		ihex_encoder_delete(enc);
+	}
+
 	ihex_delete(ihex);
 
 	return 0;
@@ -0,0 +1,230 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ihex.h>
+
+static char input_hex[] = ":020000040800F2\n"
+			  ":100000000102030405060708090A0B0C0D0E0F1068\n"
+			  ":10001000FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF0\n"
+			  ":10002000FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFE0\n"
+			  ":10003000FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFD0\n"
+			  ":10004000FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFC0\n"
+			  ":100050001122FFFF3333333333333333333333330B\n"
+			  ":10006000FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFA0\n"
+			  ":10010000FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF\n"
+			  ":10011000FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEF\n"
+			  ":10012000FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFDF\n"
+			  ":10020000FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFE\n"
+			  ":10021000FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEE\n"
+			  ":080220004444444444444444B6\n"
+			  ":00000001FF\n";
+
+/* record at 0x08 lands in elided run made of the first two records */
+static char overlap_hex[] = ":10000000FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF00\n"
+			    ":10001000FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF0\n"
+			    ":02000800AABB91\n"
+			    ":00000001FF\n";
+
+#define ARENA_PAD_SIZE (64 * 1024)
+#define ARENA_BLOCK_SIZE 4096
+
+static char *dump(struct ihex_object *ihex, size_t *size)
+{
+	char *buf;
+
+	*size = ihex_dump_size(ihex);
+	buf = malloc(*size);
+	assert(buf != NULL);
+	assert(ihex_dump_buffer(ihex, buf, *size) == 0);
+
+	return buf;
+}
+
+static void check_arena(void)
+{
+	struct ihex_object *ihex;
+	struct ihex_data_segment *seg;
+	static uint8_t image[ARENA_PAD_SIZE + 32];
+	static uint8_t data[ARENA_PAD_SIZE + 32];
+	char *hex;
+	size_t size;
+	int i;
+
+	/* 64 KiB pad byte run between two small data blocks */
+	memset(image, 0xFF, sizeof(image));
+	memset(image, 0x12, 16);
+	memset(&image[16 + ARENA_PAD_SIZE], 0x34, 16);
+	ihex = ihex_new();
+	assert(ihex != NULL);
+	assert(ihex_set_data(ihex, 0x10000000, image, sizeof(image)) == 0);
+	hex = dump(ihex, &size);
+	ihex_delete(ihex);
+
+	/* runs are elided before data reach arena, so reused object never allocates their bytes */
+	ihex = ihex_new_arena(ARENA_BLOCK_SIZE);
+	assert(ihex != NULL);
+	ihex_set_pad_elision(ihex, 64);
+	for (i = 0; i < 2; i++) {
+		ihex_reset(ihex);
+		assert(ihex_parse_buffer(ihex, hex, size) == 0);
+		assert(ihex->index_count == 2);
+		seg = ihex->segments;
+		assert((seg->adr_start == 0x10000000) && (seg->data_size == 16) && (seg->capacity < ARENA_BLOCK_SIZE));
+		seg = seg->next;
+		assert((seg->adr_start == 0x10000010 + ARENA_PAD_SIZE) && (seg->data_size == 16) && (seg->capacity < ARENA_BLOCK_SIZE));
+		assert(ihex->pad_span_count == 1);
+		assert((ihex->pad_spans[0].adr_start == 0x10000010) && (ihex->pad_spans[0].size == ARENA_PAD_SIZE));
+		assert(ihex_get_data(ihex, 0x10000000, data, sizeof(data)) == 0);
+		assert(memcmp(data, image, sizeof(image)) == 0);
+	}
+
+	ihex_delete(ihex);
+	free(hex);
+}
+
+int main(int argc, char **argv)
+{
+	struct ihex_object *ihex;
+	struct ihex_object *plain;
+	struct ihex_data_segment *seg;
+	uint8_t full[0x230];
+	uint8_t data[0x230];
+	uint8_t byte = 0x55;
+	char *plain_dump;
+	char *elided_dump;
+	size_t plain_size;
+	size_t elided_size;
+
+	plain = ihex_new();
+	assert(plain != NULL);
+	assert(ihex_parse_buffer(plain, input_hex, strlen(input_hex)) == 0);
+	assert(plain->index_count == 3);
+	assert(ihex_get_data(plain, 0x08000000, full, sizeof(full)) == 0);
+
+	/* runs of at least 32 bytes are elided, also across records and whole pad segment,
+	   shorter runs are stored as data */
+	ihex = ihex_new();
+	assert(ihex != NULL);
+	ihex_set_pad_elision(ihex, 32);
+	assert(ihex_parse_buffer(ihex, input_hex, strlen(input_hex)) == 0);
+
+	seg = ihex->segments;
+	assert((seg->adr_start == 0x08000000) && (seg->data_size == 16) && (seg->capacity == 16));
+	seg = seg->next;
+	assert((seg != NULL) && (seg->adr_start == 0x08000050) && (seg->data_size == 32) && (seg->capacity == 32));
+	assert((seg->data[2] == 0xFF) && (seg->data[3] == 0xFF) && (seg->data[31] == 0xFF));
+	seg = seg->next;
+	assert((seg != NULL) && (seg->adr_start == 0x08000220) && (seg->data_size == 8) && (seg->capacity == 8));
+	assert(seg->next == NULL);
+	assert(ihex->index_count == 3);
+
+	assert(ihex->pad_span_count == 3);
+	assert((ihex->pad_spans[0].adr_start == 0x08000010) && (ihex->pad_spans[0].size == 64));
+	assert((ihex->pad_spans[1].adr_start == 0x08000100) && (ihex->pad_spans[1].size == 48));
+	assert((ihex->pad_spans[2].adr_start == 0x08000200) && (ihex->pad_spans[2].size == 32));
+
+	assert(ihex_get_data(ihex, 0x08000000, data, sizeof(data)) == 0);
+	assert(memcmp(data, full, sizeof(full)) == 0);
+
+	/* elided runs are dumped by default, records are the same as without elision */
+	plain->align_record = 7;
+	ihex->align_record = 7;
+	plain_dump = dump(plain, &plain_size);
+	elided_dump = dump(ihex, &elided_size);
+	assert((elided_size == plain_size) && (memcmp(elided_dump, plain_dump, plain_size) == 0));
+	free(elided_dump);
+	free(plain_dump);
+	plain->align_record = 16;
+	ihex->align_record = 16;
+	plain_dump = dump(plain, &plain_size);
+	elided_dump = dump(ihex, &elided_size);
+	assert((elided_size == plain_size) && (memcmp(elided_dump, plain_dump, plain_size) == 0));
+	free(elided_dump);
+
+	/* omitted from dump on request */
+	ihex_set_pad_omission(ihex, 1);
+	elided_dump = dump(ihex, &elided_size);
+	assert(elided_size < plain_size);
+	free(elided_dump);
+	free(plain_dump);
+	ihex_set_pad_omission(ihex, 0);
+
+	/* elided runs are assigned addresses */
+	assert(ihex_set_data(ihex, 0x08000120, &byte, 1) == -1);
+	assert(ihex->error == IHEX_ERROR_DATA_OVERLAPPING);
+
+	/* fill splits elided run, compaction turns runs in filled gaps into data */
+	assert(ihex_fill(ihex, 0x08000108, 8, 0x55) == 0);
+	assert(ihex->pad_span_count == 4);
+	assert((ihex->pad_spans[1].adr_start == 0x08000100) && (ihex->pad_spans[1].size == 8));
+	assert((ihex->pad_spans[2].adr_start == 0x08000110) && (ihex->pad_spans[2].size == 32));
+	memset(&full[0x108], 0x55, 8);
+	assert(ihex_compact(ihex, 0x200) == 0);
+	assert(ihex->index_count == 1);
+	assert(ihex->pad_span_count == 0);
+	assert(ihex_get_data(ihex, 0x08000000, data, sizeof(data)) == 0);
+	assert(memcmp(data, full, sizeof(full)) == 0);
+	ihex_delete(ihex);
+
+	/* data record overlapping elided run is reported */
+	ihex = ihex_new();
+	assert(ihex != NULL);
+	ihex_set_pad_elision(ihex, 32);
+	assert(ihex_parse_buffer(ihex, overlap_hex, strlen(overlap_hex)) == -1);
+	assert(ihex->error == IHEX_ERROR_DATA_OVERLAPPING);
+
+	/* bulk load mode elides runs of sorted records */
+	ihex_reset(ihex);
+	ihex_set_bulk_load(ihex, 1);
+	assert(ihex_parse_buffer(ihex, input_hex, strlen(input_hex)) == 0);
+	assert(ihex->index_count == 3);
+	assert(ihex->pad_span_count == 3);
+	assert(ihex_get_data(ihex, 0x08000000, data, sizeof(data)) == 0);
+	assert(ihex_get_data(plain, 0x08000000, full, sizeof(full)) == 0);
+	assert(memcmp(data, full, sizeof(full)) == 0);
+
+	/* short runs on explicit call, segment is split in the middle and its trailing run is cut off */
+	assert(ihex_elide_pad(ihex, 2) == 0);
+	assert(ihex->index_count == 4);
+	seg = ihex->segments->next;
+	assert((seg->adr_start == 0x08000050) && (seg->data_size == 2));
+	seg = seg->next;
+	assert((seg->adr_start == 0x08000054) && (seg->data_size == 12));
+	seg = seg->next;
+	assert((seg->adr_start == 0x08000220) && (seg->data_size == 8) && (seg->next == NULL));
+	assert(ihex_get_data(ihex, 0x08000000, data, sizeof(data)) == 0);
+	assert(memcmp(data, full, sizeof(full)) == 0);
+
+	ihex_delete(ihex);
+	ihex_delete(plain);
+
+	check_arena();
+
+	return 0;
+}
@@ -0,0 +1,86 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ihex.h>
+
+static uint8_t blob[64];
+
+int main(int argc, char **argv)
+{
+	struct ihex_object *ihex;
+	struct ihex_frozen *frozen;
+	const uint8_t *view;
+	uint8_t data[64];
+	uint32_t i;
+
+	for (i = 0; i < sizeof(blob); i++)
+		blob[i] = (uint8_t)(i * 11 + 7);
+
+	ihex = ihex_new();
+	assert(ihex != NULL);
+
+	assert(ihex_set_data(ihex, 0x2000, &blob[16], 16) == 0);
+	assert(ihex_set_data(ihex, 0x1000, &blob[0], 16) == 0);
+	assert(ihex_set_data(ihex, 0xFFFFFFF8, &blob[32], 8) == 0);
+
+	frozen = ihex_freeze(ihex);
+	assert(frozen != NULL);
+
+	/* frozen image does not depend on object */
+	ihex_delete(ihex);
+
+	assert(frozen->range_count == 3);
+	assert(frozen->data_size == 40);
+	assert((frozen->ranges[0].adr_start == 0x1000) && (frozen->ranges[0].size == 16));
+	assert((frozen->ranges[1].adr_start == 0x2000) && (frozen->ranges[1].size == 16));
+	assert((frozen->ranges[2].adr_start == 0xFFFFFFF8) && (frozen->ranges[2].size == 8));
+	assert(frozen->ranges[1].data == frozen->ranges[0].data + 16);
+
+	/* data and holes */
+	assert(ihex_frozen_get_data(frozen, 0x0FF8, data, 32) == 0);
+	for (i = 0; i < 8; i++)
+		assert(data[i] == 0xFF);
+	assert(memcmp(&data[8], blob, 16) == 0);
+	for (i = 24; i < 32; i++)
+		assert(data[i] == 0xFF);
+
+	/* read past top of address space wraps around */
+	assert(ihex_frozen_get_data(frozen, 0xFFFFFFFC, data, 8) == 0);
+	assert(memcmp(data, &blob[36], 4) == 0);
+	for (i = 4; i < 8; i++)
+		assert(data[i] == 0xFF);
+
+	assert(ihex_frozen_get_view(frozen, 0x2004, 12, &view) == 0);
+	assert(memcmp(view, &blob[20], 12) == 0);
+	assert(ihex_frozen_get_view(frozen, 0x2004, 13, &view) != 0);
+	assert(ihex_frozen_get_view(frozen, 0x0FFF, 1, &view) != 0);
+
+	ihex_frozen_delete(frozen);
+
+	return 0;
+}
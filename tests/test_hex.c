@@ -0,0 +1,136 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ihex_hex.h>
+
+static const char hex_chars[] = "0123456789ABCDEFabcdef";
+static const char bad_chars[] = "/:@G`g \r\n\x80\xFF";
+
+static void check_kernel(ihex_hex_decode_t decode, const char *hex, uint32_t size)
+{
+	uint8_t ref_data[255];
+	uint8_t data[255];
+	uint8_t ref_sum;
+	uint8_t sum;
+	int ref_result;
+	int result;
+
+	ref_sum = 0x5A;
+	sum = 0x5A;
+	ref_result = ihex_hex_decode_scalar(hex, ref_data, size, &ref_sum);
+	result = decode(hex, data, size, &sum);
+
+	assert(result == ref_result);
+	if (result == 0) {
+		assert(sum == ref_sum);
+		assert(memcmp(data, ref_data, size) == 0);
+	}
+}
+
+static void check_kernels(const char *hex, uint32_t size)
+{
+#ifdef IHEX_HEX_SSE2
+	check_kernel(ihex_hex_decode_sse2, hex, size);
+#endif
+#ifdef IHEX_HEX_AVX2
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		check_kernel(ihex_hex_decode_avx2, hex, size);
+#endif
+#ifdef IHEX_HEX_NEON
+	check_kernel(ihex_hex_decode_neon, hex, size);
+#endif
+	check_kernel(ihex_hex_select(), hex, size);
+	check_kernel(ihex_hex_decode, hex, size);
+}
+
+static void check_encode(const uint8_t *data, uint32_t size)
+{
+	char ref_hex[2 * 255];
+	char hex[2 * 255];
+	uint8_t ref_sum;
+	uint8_t sum;
+
+	ref_sum = 0xA5;
+	ihex_hex_encode_scalar(data, ref_hex, size, &ref_sum);
+#ifdef IHEX_HEX_SSE2
+	sum = 0xA5;
+	ihex_hex_encode_sse2(data, hex, size, &sum);
+	assert(sum == ref_sum);
+	assert(memcmp(hex, ref_hex, size * 2) == 0);
+#endif
+#ifdef IHEX_HEX_NEON
+	sum = 0xA5;
+	ihex_hex_encode_neon(data, hex, size, &sum);
+	assert(sum == ref_sum);
+	assert(memcmp(hex, ref_hex, size * 2) == 0);
+#endif
+	sum = 0xA5;
+	ihex_hex_encode(data, hex, size, &sum);
+	assert(sum == ref_sum);
+	assert(memcmp(hex, ref_hex, size * 2) == 0);
+}
+
+int main(int argc, char **argv)
+{
+	char hex[2 * 255];
+	uint8_t bytes[255];
+	uint8_t data[4];
+	uint8_t sum;
+	uint32_t size;
+	uint32_t i;
+	int n;
+
+	sum = 0;
+	assert(ihex_hex_decode("0aF19c7E", data, 4, &sum) == 0);
+	assert(memcmp(data, "\x0A\xF1\x9C\x7E", 4) == 0);
+	assert(sum == (uint8_t)(0x0A + 0xF1 + 0x9C + 0x7E));
+	assert(ihex_hex_decode("0aF1xc7E", data, 4, &sum) != 0);
+
+	sum = 0;
+	ihex_hex_encode((const uint8_t *)"\x0A\xF1\x9C\x7E", hex, 4, &sum);
+	assert(memcmp(hex, "0AF19C7E", 8) == 0);
+	assert(sum == (uint8_t)(0x0A + 0xF1 + 0x9C + 0x7E));
+
+	srand(1);
+	for (n = 0; n < 20000; n++) {
+		size = rand() % 256;
+		for (i = 0; i < size * 2; i++)
+			hex[i] = hex_chars[rand() % (sizeof(hex_chars) - 1)];
+		if ((size > 0) && (n % 2 == 0))
+			hex[rand() % (size * 2)] = bad_chars[rand() % (sizeof(bad_chars) - 1)];
+		check_kernels(hex, size);
+
+		for (i = 0; i < size; i++)
+			bytes[i] = rand();
+		check_encode(bytes, size);
+	}
+
+	return 0;
+}
@@ -0,0 +1,215 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ihex.h>
+
+#define DENSE_ADDRESS 0x0800FF00
+#define DENSE_SIZE (3 * 1024 * 1024)
+#define SPARSE_ADDRESS 0x20000000
+#define SPARSE_COUNT 4096
+#define FINE_ADDRESS 0x9300FF00
+#define FINE_SIZE (128 * 1024)
+
+static char *create_hex(size_t *length)
+{
+	struct ihex_object *ihex;
+	uint8_t *data;
+	char *hex;
+	FILE *fp;
+	uint32_t i;
+
+	data = malloc(DENSE_SIZE);
+	assert(data != NULL);
+	for (i = 0; i < DENSE_SIZE; i++)
+		data[i] = (uint8_t)(i * 13 + (i >> 9));
+
+	ihex = ihex_new();
+	assert(ihex != NULL);
+	assert(ihex_set_data(ihex, DENSE_ADDRESS, data, DENSE_SIZE) == 0);
+	for (i = 0; i < SPARSE_COUNT; i++)
+		assert(ihex_set_data(ihex, SPARSE_ADDRESS + i * 97, &data[i], 1 + i % 64) == 0);
+
+	fp = open_memstream(&hex, length);
+	assert(fp != NULL);
+	assert(ihex_dump_file(ihex, fp) == 0);
+	fclose(fp);
+
+	ihex_delete(ihex);
+	free(data);
+
+	return hex;
+}
+
+static char *create_fine_hex(size_t *length)
+{
+	struct ihex_object *ihex;
+	uint8_t *data;
+	char *hex;
+	FILE *fp;
+	uint32_t i;
+
+	data = malloc(FINE_SIZE);
+	assert(data != NULL);
+	for (i = 0; i < FINE_SIZE; i++)
+		data[i] = (uint8_t)(i * 7);
+
+	/* single byte records, most chunks have no type 04 record and upper address byte is above 0x7F */
+	ihex = ihex_new();
+	assert(ihex != NULL);
+	ihex->align_record = 1;
+	assert(ihex_set_data(ihex, FINE_ADDRESS, data, FINE_SIZE) == 0);
+
+	fp = open_memstream(&hex, length);
+	assert(fp != NULL);
+	assert(ihex_dump_file(ihex, fp) == 0);
+	fclose(fp);
+
+	ihex_delete(ihex);
+	free(data);
+
+	return hex;
+}
+
+static void compare(struct ihex_object *a, struct ihex_object *b)
+{
+	struct ihex_data_segment *seg_a;
+	struct ihex_data_segment *seg_b;
+
+	seg_a = a->segments;
+	seg_b = b->segments;
+	while ((seg_a != NULL) && (seg_b != NULL)) {
+		assert(seg_a->adr_start == seg_b->adr_start);
+		assert(seg_a->data_size == seg_b->data_size);
+		assert(memcmp(seg_a->data, seg_b->data, seg_a->data_size) == 0);
+		seg_a = seg_a->next;
+		seg_b = seg_b->next;
+	}
+	assert(seg_a == NULL);
+	assert(seg_b == NULL);
+}
+
+static void check_parallel(const char *hex, size_t length)
+{
+	static const unsigned int threads[] = { 0, 1, 2, 3, 4, 7, 16 };
+	struct ihex_object *serial;
+	struct ihex_object *parallel;
+	int result;
+	unsigned int i;
+
+	serial = ihex_new();
+	assert(serial != NULL);
+	result = ihex_parse_buffer(serial, hex, length);
+
+	for (i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+		parallel = ihex_new();
+		assert(parallel != NULL);
+		assert(ihex_parse_buffer_parallel(parallel, hex, length, threads[i]) == result);
+		assert(parallel->error == serial->error);
+		if (result == 0)
+			compare(serial, parallel);
+		ihex_delete(parallel);
+	}
+
+	ihex_delete(serial);
+}
+
+static void check_parallel_dump(const char *hex, size_t length)
+{
+	static const unsigned int threads[] = { 0, 2, 5, 16 };
+	static const uint8_t aligns[] = { 16, 7, 255 };
+	struct ihex_object *ihex;
+	char *serial;
+	char *parallel;
+	size_t serial_length;
+	size_t parallel_length;
+	FILE *fp;
+	unsigned int i;
+	unsigned int j;
+
+	ihex = ihex_new();
+	assert(ihex != NULL);
+	assert(ihex_parse_buffer(ihex, hex, length) == 0);
+
+	for (j = 0; j < sizeof(aligns); j++) {
+		ihex->align_record = aligns[j];
+
+		fp = open_memstream(&serial, &serial_length);
+		assert(fp != NULL);
+		assert(ihex_dump_file(ihex, fp) == 0);
+		fclose(fp);
+
+		for (i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+			fp = open_memstream(&parallel, &parallel_length);
+			assert(fp != NULL);
+			assert(ihex_dump_file_parallel(ihex, fp, threads[i]) == 0);
+			fclose(fp);
+
+			assert(parallel_length == serial_length);
+			assert(memcmp(parallel, serial, serial_length) == 0);
+			free(parallel);
+		}
+
+		free(serial);
+	}
+
+	ihex_delete(ihex);
+}
+
+int main(int argc, char **argv)
+{
+	char *hex;
+	char *line;
+	size_t length;
+
+	hex = create_hex(&length);
+	check_parallel(hex, length);
+	check_parallel_dump(hex, length);
+
+	/* EOF record in the middle, rest is ignored */
+	line = strchr(&hex[length / 3], '\n') + 1;
+	memcpy(line, ":00000001FF\n", 12);
+	check_parallel(hex, length);
+	free(hex);
+
+	/* broken checksum in the middle */
+	hex = create_hex(&length);
+	line = strchr(&hex[length / 2], '\n') - 1;
+	*line = (*line == '0') ? '1' : '0';
+	check_parallel(hex, length);
+	free(hex);
+
+	/* extended address carried over chunks without type 04 record */
+	hex = create_fine_hex(&length);
+	check_parallel(hex, length);
+	free(hex);
+
+	return 0;
+}
@@ -22,6 +22,8 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
@@ -39,11 +41,49 @@ static char input_hex[] =
 ":0800100030464646463031320D\n"
 ":00000001FF\n";
 
+#define UNORDERED_LINE 44 /* length of 16 byte data record line */
+
+/* three separate blocks arrive first, then records bridging them out of order */
+static char input_unordered_hex[] =
+":10104000404142434445464748494A4B4C4D4E4F28\n"
+":10100000000102030405060708090A0B0C0D0E0F68\n"
+":10102000202122232425262728292A2B2C2D2E2F48\n"
+":10101000101112131415161718191A1B1C1D1E1F58\n"
+":10106000606162636465666768696A6B6C6D6E6F08\n"
+":10103000303132333435363738393A3B3C3D3E3F38\n"
+":00000001FF\n";
+
+static void check_index(struct ihex_object *ihex)
+{
+	struct ihex_data_segment *seg;
+	const uint8_t *view;
+	uint32_t count;
+
+	/* index holds every listed segment, list is sorted and segments neither touch nor overlap */
+	count = 0;
+	for (seg = ihex->segments; seg != NULL; seg = seg->next) {
+		if (seg->next != NULL) {
+			assert(seg->next->prev == seg);
+			assert(seg->adr_start + seg->data_size < seg->next->adr_start);
+		}
+		assert(ihex_get_view(ihex, seg->adr_start + seg->data_size - 1, 1, &view) == 0);
+		assert(view == &seg->data[seg->data_size - 1]);
+		count++;
+	}
+	assert(count == ihex->index_count);
+}
+
 int main(int argc, char **argv)
 {
 	struct ihex_object *ihex;
         FILE *fp;
         struct ihex_data_segment *seg;
+	uint8_t data[24];
+	struct ihex_segment_iterator iter;
+	const uint8_t *view;
+	uint32_t adr;
+	uint32_t size;
+	uint32_t i;
 
 	ihex = ihex_new();
         assert(ihex != NULL);
@@ -66,6 +106,71 @@ int main(int argc, char **argv)
         assert(seg->data_size == 16);
         assert(memcmp(seg->data, "\xFF\xFF\x01\x20\xE5\x0A\x00\x08\x29\x0B\x00\x08\x29\x0B\x00\x08", 16) == 0);
 
+	/* read spanning leading hole, segment and trailing hole */
+	ihex->pad_byte = 0xA5;
+	assert(ihex_get_data(ihex, 0x08000000, data, sizeof(data)) == 0);
+	assert(memcmp(data, "\xA5\xA5\xA5\xA5\xFF\xFF\x01\x20", 8) == 0);
+	assert(memcmp(data + 8, seg->data + 4, 12) == 0);
+	assert(memcmp(data + 20, "\xA5\xA5\xA5\xA5", 4) == 0);
+
+	/* zero copy access */
+	assert(ihex_get_view(ihex, 0x08000006, 14, &view) == 0);
+	assert(view == seg->data + 2);
+	assert(ihex_get_view(ihex, 0x08000006, 15, &view) != 0);
+	assert(ihex_get_view(ihex, 0x08000000, 1, &view) != 0);
+
+	ihex_segment_iterator_init(ihex, &iter);
+	assert(ihex_segment_iterator_next(&iter, &adr, &view, &size) == 1);
+	assert((adr == 0x0000FFF8) && (size == 32) && (view == ihex->segments->data));
+	assert(ihex_segment_iterator_next(&iter, &adr, &view, &size) == 1);
+	assert((adr == 0x08000004) && (size == 16) && (view == seg->data));
+	assert(ihex_segment_iterator_next(&iter, &adr, &view, &size) == 0);
+
+	/* read wrapping around the end of the address space */
+	assert(ihex_get_data(ihex, 0xFFFFFFFC, data, sizeof(data)) == 0);
+	assert(memcmp(data, "\xA5\xA5\xA5\xA5", 4) == 0);
+	assert(data[4] == 0xA5);
+
+	ihex_delete(ihex);
+
+	ihex = ihex_new();
+	assert(ihex != NULL);
+
+	/* each record is parsed after the previous, index is checked after every step */
+	ihex_parse_begin(ihex);
+	assert(ihex_parse_chunk(ihex, input_unordered_hex, 3 * UNORDERED_LINE) == 0);
+	check_index(ihex);
+	assert(ihex->index_count == 3);
+
+	/* record between first and second block joins them */
+	assert(ihex_parse_chunk(ihex, &input_unordered_hex[3 * UNORDERED_LINE], UNORDERED_LINE) == 0);
+	check_index(ihex);
+	assert(ihex->index_count == 2);
+	assert((ihex->segments->adr_start == 0x1000) && (ihex->segments->data_size == 0x30));
+
+	/* new block above all, then record bridging the remaining gap below it */
+	assert(ihex_parse_chunk(ihex, &input_unordered_hex[4 * UNORDERED_LINE], UNORDERED_LINE) == 0);
+	check_index(ihex);
+	assert(ihex->index_count == 3);
+	assert(ihex_parse_chunk(ihex, &input_unordered_hex[5 * UNORDERED_LINE], sizeof(input_unordered_hex) - 1 - 5 * UNORDERED_LINE) == 0);
+	assert(ihex_parse_end(ihex) == 0);
+	check_index(ihex);
+	assert(ihex->index_count == 2);
+
+	seg = ihex->segments;
+	assert((seg->adr_start == 0x1000) && (seg->data_size == 0x50));
+	for (i = 0; i < seg->data_size; i++)
+		assert(seg->data[i] == i);
+	assert((seg->next->adr_start == 0x1060) && (seg->next->data_size == 0x10) && (seg->next->next == NULL));
+
+	/* overlapping record is refused against both neighbours */
+	assert(ihex_set_data(ihex, 0x104F, data, 2) != 0);
+	assert(ihex->error == IHEX_ERROR_DATA_OVERLAPPING);
+	assert(ihex_set_data(ihex, 0x1058, data, 9) != 0);
+	assert(ihex_set_data(ihex, 0x1050, data, 16) == 0);
+	check_index(ihex);
+	assert(ihex->index_count == 1);
+
 	ihex_delete(ihex);
 
 	return 0;
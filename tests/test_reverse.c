@@ -0,0 +1,162 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ihex.h>
+
+#define IMAGE_ADDRESS 0x08000000
+#define IMAGE_SIZE_SMALL (1024 * 1024)
+#define IMAGE_SIZE_LARGE (4 * IMAGE_SIZE_SMALL)
+
+static char *dump_record(char *out, uint16_t adr, uint8_t type, const uint8_t *data, uint8_t size)
+{
+	uint8_t sum;
+	int i;
+
+	sum = size + (adr >> 8) + (adr & 0xFF) + type;
+	out += sprintf(out, ":%02X%04X%02X", size, adr, type);
+	for (i = 0; i < size; i++) {
+		out += sprintf(out, "%02X", data[i]);
+		sum += data[i];
+	}
+	out += sprintf(out, "%02X\n", (uint8_t)(0x100 - sum));
+
+	return out;
+}
+
+static char *create_reversed_hex(const uint8_t *image, uint32_t size, size_t *length)
+{
+	char *hex;
+	char *out;
+	uint32_t offset;
+	uint32_t adr;
+	uint32_t old_upper;
+	uint8_t upper[2];
+
+	hex = malloc((size_t)size * 3 + 64);
+	assert(hex != NULL);
+
+	out = hex;
+	old_upper = 0;
+	offset = size;
+	while (offset > 0) {
+		offset -= 16;
+		adr = IMAGE_ADDRESS + offset;
+		if ((adr & 0xFFFF0000) != old_upper) {
+			upper[0] = adr >> 24;
+			upper[1] = adr >> 16;
+			out = dump_record(out, 0, 0x04, upper, 2);
+			old_upper = adr & 0xFFFF0000;
+		}
+		out = dump_record(out, adr & 0xFFFF, 0x00, &image[offset], 16);
+	}
+	out = dump_record(out, 0, 0x01, NULL, 0);
+
+	*length = out - hex;
+	return hex;
+}
+
+static void parse_reversed(const uint8_t *image, uint32_t size)
+{
+	struct ihex_object *ihex;
+	struct ihex_data_segment *seg;
+	const uint8_t *buffer;
+	char *hex;
+	char *line;
+	char *eol;
+	size_t length;
+	uint32_t data_size;
+	uint32_t moves;
+	uint64_t moved_bytes;
+	uint8_t *data;
+
+	hex = create_reversed_hex(image, size, &length);
+
+	ihex = ihex_new();
+	assert(ihex != NULL);
+
+	/* parsed line by line, every change of segment buffer means all data parsed so far were copied */
+	buffer = NULL;
+	data_size = 0;
+	moves = 0;
+	moved_bytes = 0;
+	ihex_parse_begin(ihex);
+	for (line = hex; line < hex + length; line = eol + 1) {
+		eol = memchr(line, '\n', hex + length - line);
+		assert(eol != NULL);
+		assert(ihex_parse_chunk(ihex, line, eol - line + 1) == 0);
+
+		seg = ihex->segments;
+		if ((seg != NULL) && (seg->buffer != buffer)) {
+			moves++;
+			moved_bytes += data_size;
+			buffer = seg->buffer;
+		}
+		data_size = (seg != NULL) ? seg->data_size : 0;
+	}
+	assert(ihex_parse_end(ihex) == 0);
+
+	/* linear parsing copies each byte about once (geometric growth), quadratic on every record */
+	assert(moves <= 32);
+	assert(moved_bytes <= size);
+
+	assert(ihex->segments != NULL);
+	assert(ihex->segments->next == NULL);
+	assert(ihex->segments->adr_start == IMAGE_ADDRESS);
+	assert(ihex->segments->data_size == size);
+
+	data = malloc(size);
+	assert(data != NULL);
+	assert(ihex_get_data(ihex, IMAGE_ADDRESS, data, size) == 0);
+	assert(memcmp(data, image, size) == 0);
+
+	free(data);
+	free(hex);
+	ihex_delete(ihex);
+}
+
+int main(int argc, char **argv)
+{
+	uint8_t *image;
+	uint32_t i;
+
+	image = malloc(IMAGE_SIZE_LARGE);
+	assert(image != NULL);
+	for (i = 0; i < IMAGE_SIZE_LARGE; i++)
+		image[i] = (uint8_t)(i * 7 + (i >> 8));
+
+	/* parse time of descending input is measured by bench_suite (descending workload) */
+	parse_reversed(image, IMAGE_SIZE_SMALL);
+	parse_reversed(image, IMAGE_SIZE_LARGE);
+
+	free(image);
+
+	return 0;
+}
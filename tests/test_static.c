@@ -0,0 +1,108 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ihex.h>
+
+#define POOL_SEGMENTS 2
+#define POOL_DATA 256
+
+static struct ihex_object ihex;
+static struct ihex_data_segment pool_segments[POOL_SEGMENTS];
+static uint8_t pool_data[POOL_DATA];
+
+static char input_hex[] =
+":020000040800F2\n"
+":0C000400FFFF0120E50A0008290B00089E\n"
+":04001000290B0008B0\n"
+":020000040000FA\n"
+":08FFF8003A3032303030303075\n"
+":020000040001F9\n"
+":10000000343038303046320A3A31303030303430E3\n"
+":0800100030464646463031320D\n"
+":00000001FF\n";
+
+/* three separate segments, one more than pool has */
+static char segments_hex[] =
+":0400000001020304F2\n"
+":0400100001020304E2\n"
+":0400200001020304D2\n"
+":00000001FF\n";
+
+int main(int argc, char **argv)
+{
+	uint8_t block[300];
+	const uint8_t *view;
+	FILE *fp;
+	int cycle;
+
+	assert(ihex_init_static(&ihex, pool_segments, POOL_SEGMENTS, pool_data, sizeof(pool_data)) == 0);
+
+	for (cycle = 0; cycle < 3; cycle++) {
+		fp = fmemopen(input_hex, sizeof(input_hex) - 1, "r");
+		assert(fp != NULL);
+		assert(ihex_parse_file(&ihex, fp) == 0);
+		fclose(fp);
+
+		assert(ihex_get_view(&ihex, 0x0000FFF8, 32, &view) == 0);
+		assert(memcmp(view, ":020000040800F2\n:10000400FFFF012", 32) == 0);
+		assert(ihex_get_view(&ihex, 0x08000004, 16, &view) == 0);
+		assert(memcmp(view, "\xFF\xFF\x01\x20\xE5\x0A\x00\x08\x29\x0B\x00\x08\x29\x0B\x00\x08", 16) == 0);
+
+		ihex_reset(&ihex);
+		assert(ihex.segments == NULL);
+	}
+
+	/* out of segment descriptors */
+	assert(ihex_parse_buffer(&ihex, segments_hex, sizeof(segments_hex) - 1) != 0);
+	assert(ihex.error == IHEX_ERROR_POOL);
+	ihex_reset(&ihex);
+
+	/* out of data memory */
+	memset(block, 0x5A, sizeof(block));
+	assert(ihex_set_data(&ihex, 0x1000, block, sizeof(block)) != 0);
+	assert(ihex.error == IHEX_ERROR_POOL);
+	ihex_reset(&ihex);
+
+	/* released pool memory is usable again */
+	assert(ihex_set_data(&ihex, 0x1000, block, 128) == 0);
+	assert(ihex_set_data(&ihex, 0x1080, block, 64) == 0);
+	assert(ihex_get_view(&ihex, 0x1000, 192, &view) == 0);
+	ihex_reset(&ihex);
+
+	/* data buffer without room for any data is rejected, object never falls back to heap */
+	assert(ihex_init_static(&ihex, pool_segments, POOL_SEGMENTS, pool_data, 16) != 0);
+	assert(ihex.error == IHEX_ERROR_POOL);
+	ihex_reset(&ihex);
+	assert(ihex_set_data(&ihex, 0x1000, block, 16) != 0);
+	assert(ihex.error == IHEX_ERROR_POOL);
+	ihex_reset(&ihex);
+
+	return 0;
+}
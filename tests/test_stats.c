@@ -0,0 +1,93 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ihex.h>
+
+static char input_hex[] = ":020000040000FA\n"
+			  ":0400100001020304E2\n"
+			  ":0400140005060708CE\n"
+			  ":04000C00090A0B0CC6\n"
+			  ":040020000D0E0F10A2\n"
+			  ":0800180011121314151617183C\n"
+			  ":04000005000000CD2A\n"
+			  ":00000001FF\n";
+
+/* second record has wrong checksum */
+static char bad_hex[] = ":0400100001020304E2\n"
+			":0400140005060708CF\n";
+
+static struct ihex_data_segment segments[8];
+static uint8_t pool[1024];
+
+int main(int argc, char **argv)
+{
+	struct ihex_object ihex;
+	struct ihex_stats stats;
+	uint8_t data[4] = { 25, 26, 27, 28 };
+
+	assert(ihex_init_static(&ihex, segments, 8, pool, sizeof(pool)) == 0);
+
+	assert(ihex_parse_buffer(&ihex, input_hex, strlen(input_hex)) == 0);
+	ihex_get_stats(&ihex, &stats);
+
+	assert(stats.records[0x00] == 5);
+	assert(stats.records[0x01] == 1);
+	assert(stats.records[0x02] == 0);
+	assert(stats.records[0x04] == 1);
+	assert(stats.records[0x05] == 1);
+	assert(stats.data_bytes == 24);
+	assert(stats.segments == 1);
+	assert(stats.join_left_bytes == 0);
+	assert(stats.join_right_bytes >= 4);
+	assert(stats.insert_between_bytes == 8 + 4);
+	assert(stats.nodes_visited > 0);
+	assert(stats.parse_ns >= stats.merge_ns);
+
+	/* data appended with set_data are copied by join left */
+	assert(ihex_set_data(&ihex, 0x24, data, sizeof(data)) == 0);
+	ihex_get_stats(&ihex, &stats);
+	assert(stats.join_left_bytes == 4);
+
+	assert(ihex_dump_size(&ihex) > 0);
+
+	ihex_clear_stats(&ihex);
+	ihex_get_stats(&ihex, &stats);
+	assert((stats.records[0x00] == 0) && (stats.data_bytes == 0) && (stats.nodes_visited == 0));
+	assert((stats.parse_ns == 0) && (stats.dump_ns == 0));
+	assert(stats.segments == 1);
+
+	/* time of failed parse is counted too */
+	ihex_reset(&ihex);
+	assert(ihex_parse_buffer(&ihex, bad_hex, strlen(bad_hex)) != 0);
+	ihex_get_stats(&ihex, &stats);
+	assert(stats.records[0x00] == 1);
+	assert((stats.parse_ns > 0) && (stats.merge_ns == 0));
+	ihex_reset(&ihex);
+
+	return 0;
+}
@@ -0,0 +1,86 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ihex.h>
+
+static uint8_t blob[64];
+
+int main(int argc, char **argv)
+{
+	struct ihex_object *ihex;
+	struct ihex_data_segment *seg;
+	const uint8_t *view;
+	uint8_t data[64];
+	uint32_t i;
+
+	/* unsorted blocks touching each other and existing segments on both sides */
+	struct ihex_data_vec vec[] = {
+		{ 0x1020, &blob[32], 16 },
+		{ 0x1010, &blob[16], 16 },
+		{ 0x2000, &blob[0], 8 },
+		{ 0x1004, &blob[4], 12 },
+		{ 0x1030, &blob[48], 0 },
+	};
+
+	/* second block overlaps first one */
+	struct ihex_data_vec vec_overlap[] = {
+		{ 0x3000, &blob[0], 8 },
+		{ 0x3004, &blob[4], 8 },
+		{ 0x4000, &blob[0], 8 },
+	};
+
+	for (i = 0; i < sizeof(blob); i++)
+		blob[i] = (uint8_t)(i * 3 + 1);
+
+	ihex = ihex_new();
+	assert(ihex != NULL);
+
+	assert(ihex_set_data(ihex, 0x1000, &blob[0], 4) == 0);
+	assert(ihex_set_data(ihex, 0x1030, &blob[48], 16) == 0);
+	assert(ihex_set_data_vec(ihex, vec, sizeof(vec) / sizeof(vec[0])) == 0);
+
+	seg = ihex->segments;
+	assert((seg != NULL) && (seg->adr_start == 0x1000) && (seg->data_size == 64));
+	assert(memcmp(seg->data, blob, 64) == 0);
+	seg = seg->next;
+	assert((seg != NULL) && (seg->adr_start == 0x2000) && (seg->data_size == 8));
+	assert(seg->next == NULL);
+	assert(ihex->index_count == 2);
+
+	/* same result as sequential calls, first block is added before error */
+	assert(ihex_set_data_vec(ihex, vec_overlap, sizeof(vec_overlap) / sizeof(vec_overlap[0])) != 0);
+	assert(ihex->error == IHEX_ERROR_DATA_OVERLAPPING);
+	assert(ihex_get_view(ihex, 0x3000, 8, &view) == 0);
+	assert(memcmp(view, blob, 8) == 0);
+	assert(ihex_get_data(ihex, 0x4000, data, 8) == 0);
+	assert(data[0] == ihex->pad_byte);
+
+	ihex_delete(ihex);
+
+	return 0;
+}
@@ -0,0 +1,103 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ihex.h>
+
+static uint8_t blob[64];
+
+int main(int argc, char **argv)
+{
+	struct ihex_object *ihex;
+	struct ihex_data_segment *seg, *right;
+	uint8_t data[64];
+	uint8_t *ptr;
+	uint32_t i;
+
+	for (i = 0; i < sizeof(blob); i++)
+		blob[i] = (uint8_t)(i * 5 + 3);
+
+	ihex = ihex_new();
+	assert(ihex != NULL);
+
+	assert(ihex_set_data(ihex, 0x1000, &blob[0], 16) == 0);
+	assert(ihex_set_data(ihex, 0x1020, &blob[32], 16) == 0);
+
+	/* overwrite inside segment is done in place */
+	ptr = ihex->segments->data;
+	assert(ihex_write_data(ihex, 0x1004, &blob[48], 4) == 0);
+	assert(ihex->segments->data == ptr);
+	assert(memcmp(&ptr[4], &blob[48], 4) == 0);
+	assert(ihex_write_data(ihex, 0x1004, &blob[4], 4) == 0);
+
+	/* write spanning hole joins both segments */
+	assert(ihex_write_data(ihex, 0x100C, &blob[12], 24) == 0);
+	seg = ihex->segments;
+	assert((seg->adr_start == 0x1000) && (seg->data_size == 48));
+	assert(memcmp(seg->data, blob, 48) == 0);
+	assert(seg->next == NULL);
+
+	/* fill extends segment */
+	assert(ihex_fill(ihex, 0x1028, 16, 0xA5) == 0);
+	assert(ihex_get_data(ihex, 0x1028, data, 16) == 0);
+	for (i = 0; i < 16; i++)
+		assert(data[i] == 0xA5);
+	assert((seg->data_size == 56) && (seg->next == NULL));
+
+	/* erase in the middle splits segment without copying */
+	assert(ihex_erase(ihex, 0x1010, 8) == 0);
+	seg = ihex->segments;
+	right = seg->next;
+	assert((seg->adr_start == 0x1000) && (seg->data_size == 16));
+	assert((right != NULL) && (right->adr_start == 0x1018) && (right->data_size == 32));
+	assert((right->buffer == seg->buffer) && (right->shared == seg) && (seg->shared == right));
+	assert(ihex->index_count == 2);
+	assert(ihex_get_data(ihex, 0x1010, data, 8) == 0);
+	for (i = 0; i < 8; i++)
+		assert(data[i] == ihex->pad_byte);
+
+	/* erased gap accepts new data again */
+	assert(ihex_set_data(ihex, 0x1010, &blob[16], 8) == 0);
+	seg = ihex->segments;
+	assert((seg->data_size == 56) && (seg->next == NULL));
+	assert(memcmp(seg->data, blob, 40) == 0);
+
+	/* head and tail cuts */
+	assert(ihex_erase(ihex, 0x0F00, 0x104) == 0);
+	assert(ihex_erase(ihex, 0x1030, 0x100) == 0);
+	seg = ihex->segments;
+	assert((seg->adr_start == 0x1004) && (seg->data_size == 44) && (seg->next == NULL));
+	assert(memcmp(seg->data, &blob[4], 36) == 0);
+
+	/* erase everything */
+	assert(ihex_erase(ihex, 0x1000, 0x100) == 0);
+	assert((ihex->segments == NULL) && (ihex->index_count == 0));
+
+	ihex_delete(ihex);
+
+	return 0;
+}